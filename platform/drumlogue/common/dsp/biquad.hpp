@@ -0,0 +1,728 @@
+#pragma once
+/**
+ * @file biquad.hpp
+ * @brief Generic biquad structures and block processing
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "attributes.h"
+
+namespace dsp {
+
+/**
+ * Transposed form 2 Bi-Quad construct for FIR/IIR filters.
+ *
+ * Coefficient helpers and per-sample processing match the dsp::BiQuad of
+ * the prologue, minilogue xd and NTS-1 digital SDKs.
+ */
+struct BiQuad {
+  /**
+   * Filter coefficients
+   */
+  struct Coeffs {
+    float ff0;
+    float ff1;
+    float ff2;
+    float fb1;
+    float fb2;
+
+    Coeffs() : ff0(0), ff1(0), ff2(0), fb1(0), fb2(0) {}
+
+    /**
+     * Convert Hz frequency to normalized frequency
+     *
+     * @param fc Frequency in Hz
+     * @param fsrecip Reciprocal of sampling frequency (1/Fs)
+     */
+    static fast_inline float wc(const float fc, const float fsrecip) { return fc * fsrecip; }
+
+    /**
+     * Pass-through, single unity feed forward tap.
+     */
+    fast_inline void setIdentity(void) {
+      ff0 = 1.f;
+      ff1 = ff2 = fb1 = fb2 = 0.f;
+    }
+
+    /**
+     * First order low pass filter.
+     *
+     * @param k Tangent of PI x cutoff frequency in radians: tan(pi*wc)
+     */
+    fast_inline void setFOLP(const float k) {
+      const float kp1 = k + 1.f;
+      const float km1 = k - 1.f;
+      ff0 = ff1 = k / kp1;
+      fb1 = km1 / kp1;
+      fb2 = ff2 = 0.f;
+    }
+
+    /**
+     * First order high pass filter.
+     *
+     * @param k Tangent of PI x cutoff frequency in radians: tan(pi*wc)
+     */
+    fast_inline void setFOHP(const float k) {
+      const float kp1 = k + 1.f;
+      const float km1 = k - 1.f;
+      ff0 = 1.f / kp1;
+      ff1 = -ff0;
+      fb1 = km1 / kp1;
+      fb2 = ff2 = 0.f;
+    }
+
+    /**
+     * First order all pass filter.
+     *
+     * @param k Tangent of PI x cutoff frequency in radians: tan(pi*wc)
+     */
+    fast_inline void setFOAP(const float k) {
+      const float kp1 = k + 1.f;
+      const float km1 = k - 1.f;
+      ff0 = fb1 = km1 / kp1;
+      ff1 = 1.f;
+      fb2 = ff2 = 0.f;
+    }
+
+    /**
+     * Second order low pass filter.
+     *
+     * @param k Tangent of PI x cutoff frequency in radians: tan(pi*wc)
+     * @param q Resonance with flat response at q = sqrt(2)
+     */
+    fast_inline void setSOLP(const float k, const float q) {
+      const float qk2 = q * k * k;
+      const float qk2_k_q_r = 1.f / (qk2 + k + q);
+      ff0 = ff2 = qk2 * qk2_k_q_r;
+      ff1 = 2.f * ff0;
+      fb1 = 2.f * (qk2 - q) * qk2_k_q_r;
+      fb2 = (qk2 - k + q) * qk2_k_q_r;
+    }
+
+    /**
+     * Second order high pass filter.
+     *
+     * @param k Tangent of PI x cutoff frequency in radians: tan(pi*wc)
+     * @param q Resonance with flat response at q = sqrt(2)
+     */
+    fast_inline void setSOHP(const float k, const float q) {
+      const float qk2 = q * k * k;
+      const float qk2_k_q_r = 1.f / (qk2 + k + q);
+      ff0 = ff2 = q * qk2_k_q_r;
+      ff1 = -2.f * ff0;
+      fb1 = 2.f * (qk2 - q) * qk2_k_q_r;
+      fb2 = (qk2 - k + q) * qk2_k_q_r;
+    }
+
+    /**
+     * Second order band pass filter.
+     *
+     * @param k Tangent of PI x cutoff frequency in radians: tan(pi*wc)
+     * @param q Inverse of relative bandwidth (Fc / Fb)
+     */
+    fast_inline void setSOBP(const float k, const float q) {
+      const float qk2 = q * k * k;
+      const float qk2_k_q_r = 1.f / (qk2 + k + q);
+      ff0 = k * qk2_k_q_r;
+      ff1 = 0.f;
+      ff2 = -ff0;
+      fb1 = 2.f * (qk2 - q) * qk2_k_q_r;
+      fb2 = (qk2 - k + q) * qk2_k_q_r;
+    }
+
+    /**
+     * Second order band reject filter.
+     *
+     * @param k Tangent of PI x cutoff frequency in radians: tan(pi*wc)
+     * @param q Inverse of relative bandwidth (Fc / Fb)
+     */
+    fast_inline void setSOBR(const float k, const float q) {
+      const float qk2 = q * k * k;
+      const float qk2_k_q_r = 1.f / (qk2 + k + q);
+      ff0 = ff2 = (qk2 + q) * qk2_k_q_r;
+      ff1 = fb1 = 2.f * (qk2 - q) * qk2_k_q_r;
+      fb2 = (qk2 - k + q) * qk2_k_q_r;
+    }
+
+    /**
+     * Second order all pass filter.
+     *
+     * @param k Tangent of PI x cutoff frequency in radians: tan(pi*wc)
+     * @param q Inverse of relative bandwidth (Fc / Fb)
+     */
+    fast_inline void setSOAP1(const float k, const float q) {
+      const float qk2 = q * k * k;
+      const float qk2_k_q_r = 1.f / (qk2 + k + q);
+      ff0 = fb2 = (qk2 - k + q) * qk2_k_q_r;
+      ff1 = fb1 = 2.f * (qk2 - q) * qk2_k_q_r;
+      ff2 = 1.f;
+    }
+  };
+
+  BiQuad(void) : z1_(0), z2_(0) {}
+
+  /**
+   * Flush internal delays
+   */
+  fast_inline void flush(void) { z1_ = z2_ = 0; }
+
+  /**
+   * Second order processing of one sample
+   */
+  fast_inline float process_so(const float xn) {
+    const float acc = coeffs_.ff0 * xn + z1_;
+    z1_ = coeffs_.ff1 * xn + z2_ - coeffs_.fb1 * acc;
+    z2_ = coeffs_.ff2 * xn - coeffs_.fb2 * acc;
+    return acc;
+  }
+
+  /**
+   * First order processing of one sample
+   */
+  fast_inline float process_fo(const float xn) {
+    const float acc = coeffs_.ff0 * xn + z1_;
+    z1_ = coeffs_.ff1 * xn - coeffs_.fb1 * acc;
+    return acc;
+  }
+
+  /**
+   * Default processing function (second order)
+   */
+  fast_inline float process(const float xn) { return process_so(xn); }
+
+  Coeffs coeffs_;
+  float z1_, z2_;
+};
+
+/**
+ * Stereo second order section running left and right channels in lockstep.
+ *
+ * Processes interleaved L/R buffers as found in drumlogue effect units
+ * directly, without de-interleaving. On NEON targets both channels share one
+ * float32x2_t lane pair for coefficients, delays and arithmetic, halving the
+ * cost of two mono BiQuad instances.
+ */
+class StereoBiQuad {
+ public:
+  StereoBiQuad(void) {
+    BiQuad::Coeffs c;
+    c.setIdentity();
+    setCoeffs(c);
+    flush();
+  }
+
+  /**
+   * Flush internal delays of both channels
+   */
+  fast_inline void flush(void) { z1_[0] = z1_[1] = z2_[0] = z2_[1] = 0.f; }
+
+  /**
+   * Set the same coefficients on both channels.
+   */
+  fast_inline void setCoeffs(const BiQuad::Coeffs &c) { setCoeffs(c, c); }
+
+  /**
+   * Set separate coefficients per channel.
+   *
+   * @param l Left channel coefficients
+   * @param r Right channel coefficients
+   */
+  fast_inline void setCoeffs(const BiQuad::Coeffs &l, const BiQuad::Coeffs &r) {
+    b0_[0] = l.ff0;
+    b1_[0] = l.ff1;
+    b2_[0] = l.ff2;
+    a1_[0] = l.fb1;
+    a2_[0] = l.fb2;
+    b0_[1] = r.ff0;
+    b1_[1] = r.ff1;
+    b2_[1] = r.ff2;
+    a1_[1] = r.fb1;
+    a2_[1] = r.fb2;
+  }
+
+  /**
+   * Filter an interleaved stereo buffer.
+   *
+   * @param x Interleaved L/R input buffer
+   * @param y Interleaved L/R output buffer, may be the same as x
+   * @param frames Number of stereo frames
+   */
+  fast_inline void process(const float *x, float *y, size_t frames) {
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    const float32x2_t b0 = vld1_f32(b0_);
+    const float32x2_t b1 = vld1_f32(b1_);
+    const float32x2_t b2 = vld1_f32(b2_);
+    const float32x2_t a1 = vld1_f32(a1_);
+    const float32x2_t a2 = vld1_f32(a2_);
+    float32x2_t z1 = vld1_f32(z1_);
+    float32x2_t z2 = vld1_f32(z2_);
+
+    for (const float *x_e = x + 2 * frames; x != x_e; x += 2, y += 2) {
+      const float32x2_t xn = vld1_f32(x);
+      const float32x2_t yn = vmla_f32(z1, b0, xn);
+      z1 = vmls_f32(vmla_f32(z2, b1, xn), a1, yn);
+      z2 = vmls_f32(vmul_f32(b2, xn), a2, yn);
+      vst1_f32(y, yn);
+    }
+
+    vst1_f32(z1_, z1);
+    vst1_f32(z2_, z2);
+#else
+    float z1l = z1_[0], z2l = z2_[0];
+    float z1r = z1_[1], z2r = z2_[1];
+
+    for (const float *x_e = x + 2 * frames; x != x_e; x += 2, y += 2) {
+      const float xl = x[0], xr = x[1];
+      const float yl = b0_[0] * xl + z1l;
+      const float yr = b0_[1] * xr + z1r;
+      z1l = b1_[0] * xl + z2l - a1_[0] * yl;
+      z1r = b1_[1] * xr + z2r - a1_[1] * yr;
+      z2l = b2_[0] * xl - a2_[0] * yl;
+      z2r = b2_[1] * xr - a2_[1] * yr;
+      y[0] = yl;
+      y[1] = yr;
+    }
+
+    z1_[0] = z1l;
+    z2_[0] = z2l;
+    z1_[1] = z1r;
+    z2_[1] = z2r;
+#endif
+  }
+
+ private:
+  // Note: L/R pairs, laid out for 64-bit vector loads
+  float b0_[2] __attribute__((aligned(8)));
+  float b1_[2] __attribute__((aligned(8)));
+  float b2_[2] __attribute__((aligned(8)));
+  float a1_[2] __attribute__((aligned(8)));
+  float a2_[2] __attribute__((aligned(8)));
+  float z1_[2] __attribute__((aligned(8)));
+  float z2_[2] __attribute__((aligned(8)));
+};
+
+/**
+ * Cascade of N second order sections with block processing.
+ *
+ * A whole buffer is filtered per call, coefficients and delays stay in
+ * registers for the duration of the block.
+ *
+ * The NEON path runs groups of four sections in the lanes of one vector as a
+ * wavefront: lane k filters sample n-k while lane k-1 produces its input, so
+ * one vector step advances four sections by one sample. The pipeline is
+ * filled and drained within each call, adding no latency. Sections beyond N
+ * in the last group are identity sections.
+ *
+ * @tparam N Number of sections.
+ */
+template <size_t N>
+class BiQuadCascade {
+ public:
+  static_assert(N > 0, "At least one section is required.");
+
+  BiQuadCascade(void) {
+    for (size_t i = 0; i < kPaddedSections; ++i) {
+      b0_[i] = 1.f;
+      b1_[i] = b2_[i] = a1_[i] = a2_[i] = 0.f;
+    }
+    flush();
+  }
+
+  /**
+   * Flush internal delays of all sections
+   */
+  fast_inline void flush(void) {
+    for (size_t i = 0; i < kPaddedSections; ++i) z1_[i] = z2_[i] = 0.f;
+  }
+
+  /**
+   * Set coefficients of a section.
+   *
+   * @param section Section index, in [0, N-1]
+   * @param c Coefficients, e.g. set with BiQuad::Coeffs::setSOLP(..)
+   */
+  fast_inline void setCoeffs(size_t section, const BiQuad::Coeffs &c) {
+    b0_[section] = c.ff0;
+    b1_[section] = c.ff1;
+    b2_[section] = c.ff2;
+    a1_[section] = c.fb1;
+    a2_[section] = c.fb2;
+  }
+
+  /**
+   * Set the same coefficients on all sections, e.g. for steeper slopes.
+   */
+  fast_inline void setCoeffs(const BiQuad::Coeffs &c) {
+    for (size_t i = 0; i < N; ++i) setCoeffs(i, c);
+  }
+
+  /**
+   * Filter a buffer through all sections.
+   *
+   * @param x Input buffer
+   * @param y Output buffer, may be the same as x
+   * @param frames Number of samples
+   */
+  fast_inline void process(const float *x, float *y, size_t frames) {
+    if (frames == 0) return;
+    const float *src = x;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (size_t g = 0; g < kPaddedSections; g += 4, src = y) processGroup(g, src, y, frames);
+#else
+    for (size_t s = 0; s < N; ++s, src = y) processSection(s, src, y, frames);
+#endif
+  }
+
+  /**
+   * Filter one sample through all sections.
+   */
+  fast_inline float process(float xn) {
+    for (size_t s = 0; s < N; ++s) {
+      const float acc = b0_[s] * xn + z1_[s];
+      z1_[s] = b1_[s] * xn + z2_[s] - a1_[s] * acc;
+      z2_[s] = b2_[s] * xn - a2_[s] * acc;
+      xn = acc;
+    }
+    return xn;
+  }
+
+ private:
+  static constexpr size_t kPaddedSections = (N + 3) & ~static_cast<size_t>(3);
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+  fast_inline void processGroup(size_t g, const float *src, float *dst, size_t frames) {
+    const float32x4_t b0 = vld1q_f32(&b0_[g]);
+    const float32x4_t b1 = vld1q_f32(&b1_[g]);
+    const float32x4_t b2 = vld1q_f32(&b2_[g]);
+    const float32x4_t a1 = vld1q_f32(&a1_[g]);
+    const float32x4_t a2 = vld1q_f32(&a2_[g]);
+    float32x4_t z1 = vld1q_f32(&z1_[g]);
+    float32x4_t z2 = vld1q_f32(&z2_[g]);
+    float32x4_t acc = vdupq_n_f32(0.f);
+
+    static const int32_t kLanes[4] = {0, 1, 2, 3};
+    const int32x4_t lanes = vld1q_s32(kLanes);
+    const int32x4_t len = vdupq_n_s32(static_cast<int32_t>(frames));
+
+    // Note: lane k is active at step t while it has a sample, 0 <= t-k < frames
+    const size_t steps = frames + 3;
+    for (size_t t = 0; t < steps; ++t) {
+      const float32x4_t xn = vextq_f32(vld1q_dup_f32(&src[(t < frames) ? t : frames - 1]), acc, 3);
+      const float32x4_t out = vmlaq_f32(z1, b0, xn);
+      float32x4_t nz1 = vmlsq_f32(vmlaq_f32(z2, b1, xn), a1, out);
+      float32x4_t nz2 = vmlsq_f32(vmulq_f32(b2, xn), a2, out);
+      if (t < 3 || t >= frames) {
+        const int32x4_t n = vsubq_s32(vdupq_n_s32(static_cast<int32_t>(t)), lanes);
+        const uint32x4_t active = vandq_u32(vcgeq_s32(n, vdupq_n_s32(0)), vcltq_s32(n, len));
+        nz1 = vbslq_f32(active, nz1, z1);
+        nz2 = vbslq_f32(active, nz2, z2);
+      }
+      z1 = nz1;
+      z2 = nz2;
+      acc = out;
+      if (t >= 3) dst[t - 3] = vgetq_lane_f32(out, 3);
+    }
+
+    vst1q_f32(&z1_[g], z1);
+    vst1q_f32(&z2_[g], z2);
+  }
+#else
+  fast_inline void processSection(size_t s, const float *src, float *dst, size_t frames) {
+    const float b0 = b0_[s], b1 = b1_[s], b2 = b2_[s], a1 = a1_[s], a2 = a2_[s];
+    float z1 = z1_[s], z2 = z2_[s];
+
+    // Note: inputs of a group are read before outputs are written, so that src may alias dst
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+      const float x0 = src[i], x1 = src[i + 1], x2 = src[i + 2], x3 = src[i + 3];
+      const float y0 = b0 * x0 + z1;
+      z1 = b1 * x0 + z2 - a1 * y0;
+      z2 = b2 * x0 - a2 * y0;
+      const float y1 = b0 * x1 + z1;
+      z1 = b1 * x1 + z2 - a1 * y1;
+      z2 = b2 * x1 - a2 * y1;
+      const float y2 = b0 * x2 + z1;
+      z1 = b1 * x2 + z2 - a1 * y2;
+      z2 = b2 * x2 - a2 * y2;
+      const float y3 = b0 * x3 + z1;
+      z1 = b1 * x3 + z2 - a1 * y3;
+      z2 = b2 * x3 - a2 * y3;
+      dst[i] = y0;
+      dst[i + 1] = y1;
+      dst[i + 2] = y2;
+      dst[i + 3] = y3;
+    }
+    for (; i < frames; ++i) {
+      const float xn = src[i];
+      const float yn = b0 * xn + z1;
+      z1 = b1 * xn + z2 - a1 * yn;
+      z2 = b2 * xn - a2 * yn;
+      dst[i] = yn;
+    }
+
+    z1_[s] = z1;
+    z2_[s] = z2;
+  }
+#endif
+
+  // Note: structure of arrays, padded to groups of four sections for vector loads
+  float b0_[kPaddedSections] __attribute__((aligned(16)));
+  float b1_[kPaddedSections] __attribute__((aligned(16)));
+  float b2_[kPaddedSections] __attribute__((aligned(16)));
+  float a1_[kPaddedSections] __attribute__((aligned(16)));
+  float a2_[kPaddedSections] __attribute__((aligned(16)));
+  float z1_[kPaddedSections] __attribute__((aligned(16)));
+  float z2_[kPaddedSections] __attribute__((aligned(16)));
+};
+
+/**
+ * Bank of N independent second order sections, one per synth voice.
+ *
+ * Coefficients and delays are stored as structure of arrays so that NEON
+ * targets filter four voices per float32x4_t operation, each voice with its
+ * own coefficients.
+ *
+ * Voice buffers are frame-major: sample n of voice v is at x[n * N + v],
+ * so a render loop can write the oscillator outputs of all voices for one
+ * frame contiguously.
+ *
+ * @tparam N Number of voices, multiple of 4.
+ */
+template <size_t N>
+class BiQuadBank {
+ public:
+  static_assert(N > 0 && (N & 3) == 0, "Number of voices must be a multiple of 4.");
+
+  BiQuadBank(void) {
+    BiQuad::Coeffs c;
+    c.setIdentity();
+    for (size_t v = 0; v < N; ++v) setCoeffs(v, c);
+    flush();
+  }
+
+  /**
+   * Flush internal delays of all voices
+   */
+  fast_inline void flush(void) {
+    for (size_t v = 0; v < N; ++v) z1_[v] = z2_[v] = 0.f;
+  }
+
+  /**
+   * Flush internal delays of one voice, e.g. on note on.
+   */
+  fast_inline void flush(size_t voice) { z1_[voice] = z2_[voice] = 0.f; }
+
+  /**
+   * Set coefficients of a voice.
+   *
+   * @param voice Voice index, in [0, N-1]
+   * @param c Coefficients, e.g. set with BiQuad::Coeffs::setSOLP(..)
+   */
+  fast_inline void setCoeffs(size_t voice, const BiQuad::Coeffs &c) {
+    b0_[voice] = c.ff0;
+    b1_[voice] = c.ff1;
+    b2_[voice] = c.ff2;
+    a1_[voice] = c.fb1;
+    a2_[voice] = c.fb2;
+  }
+
+  /**
+   * Filter one sample of every voice.
+   *
+   * @param x N input samples, one per voice
+   * @param y N output samples, may be the same as x
+   */
+  fast_inline void process(const float *x, float *y) { process(x, y, 1); }
+
+  /**
+   * Filter a frame-major block of all voices.
+   *
+   * @param x Input buffer, frames * N samples
+   * @param y Output buffer, may be the same as x
+   * @param frames Number of frames
+   */
+  fast_inline void process(const float *x, float *y, size_t frames) {
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (size_t g = 0; g < N; g += 4) {
+      const float32x4_t b0 = vld1q_f32(&b0_[g]);
+      const float32x4_t b1 = vld1q_f32(&b1_[g]);
+      const float32x4_t b2 = vld1q_f32(&b2_[g]);
+      const float32x4_t a1 = vld1q_f32(&a1_[g]);
+      const float32x4_t a2 = vld1q_f32(&a2_[g]);
+      float32x4_t z1 = vld1q_f32(&z1_[g]);
+      float32x4_t z2 = vld1q_f32(&z2_[g]);
+
+      for (size_t i = 0, o = g; i < frames; ++i, o += N) {
+        const float32x4_t xn = vld1q_f32(&x[o]);
+        const float32x4_t yn = vmlaq_f32(z1, b0, xn);
+        z1 = vmlsq_f32(vmlaq_f32(z2, b1, xn), a1, yn);
+        z2 = vmlsq_f32(vmulq_f32(b2, xn), a2, yn);
+        vst1q_f32(&y[o], yn);
+      }
+
+      vst1q_f32(&z1_[g], z1);
+      vst1q_f32(&z2_[g], z2);
+    }
+#else
+    for (size_t v = 0; v < N; ++v) {
+      const float b0 = b0_[v], b1 = b1_[v], b2 = b2_[v], a1 = a1_[v], a2 = a2_[v];
+      float z1 = z1_[v], z2 = z2_[v];
+
+      for (size_t i = 0, o = v; i < frames; ++i, o += N) {
+        const float xn = x[o];
+        const float yn = b0 * xn + z1;
+        z1 = b1 * xn + z2 - a1 * yn;
+        z2 = b2 * xn - a2 * yn;
+        y[o] = yn;
+      }
+
+      z1_[v] = z1;
+      z2_[v] = z2;
+    }
+#endif
+  }
+
+ private:
+  float b0_[N] __attribute__((aligned(16)));
+  float b1_[N] __attribute__((aligned(16)));
+  float b2_[N] __attribute__((aligned(16)));
+  float a1_[N] __attribute__((aligned(16)));
+  float a2_[N] __attribute__((aligned(16)));
+  float z1_[N] __attribute__((aligned(16)));
+  float z2_[N] __attribute__((aligned(16)));
+};
+
+/**
+ * Second order section with linearly ramped coefficients.
+ *
+ * Target coefficients are computed once per block, e.g. with
+ * BiQuad::Coeffs::setSOLP(..), and the active coefficients ramp to them over
+ * the given number of samples. This avoids both the per-sample cost of
+ * recomputing coefficients and the zipper noise of stepping them per block.
+ *
+ * Intermediate coefficients are not guaranteed to be stable, keep per-block
+ * changes moderate, e.g. at modulation rate.
+ */
+class SmoothBiQuad {
+ public:
+  SmoothBiQuad(void) : z1_(0), z2_(0), ramp_(0) {
+    coeffs_.setIdentity();
+    target_ = coeffs_;
+  }
+
+  /**
+   * Flush internal delays
+   */
+  fast_inline void flush(void) { z1_ = z2_ = 0; }
+
+  /**
+   * Set coefficients immediately, cancelling any ramp in progress.
+   */
+  fast_inline void setCoeffs(const BiQuad::Coeffs &c) {
+    coeffs_ = target_ = c;
+    ramp_ = 0;
+  }
+
+  /**
+   * Ramp coefficients to new target values.
+   *
+   * @param c Target coefficients
+   * @param frames Number of samples over which to ramp, typically the block size
+   */
+  fast_inline void setTarget(const BiQuad::Coeffs &c, size_t frames) {
+    if (frames == 0) {
+      setCoeffs(c);
+      return;
+    }
+    const float r = 1.f / frames;
+    delta_.ff0 = (c.ff0 - coeffs_.ff0) * r;
+    delta_.ff1 = (c.ff1 - coeffs_.ff1) * r;
+    delta_.ff2 = (c.ff2 - coeffs_.ff2) * r;
+    delta_.fb1 = (c.fb1 - coeffs_.fb1) * r;
+    delta_.fb2 = (c.fb2 - coeffs_.fb2) * r;
+    target_ = c;
+    ramp_ = frames;
+  }
+
+  /**
+   * Filter a buffer.
+   *
+   * @param x Input buffer
+   * @param y Output buffer, may be the same as x
+   * @param frames Number of samples
+   */
+  fast_inline void process(const float *x, float *y, size_t frames) {
+    float b0 = coeffs_.ff0, b1 = coeffs_.ff1, b2 = coeffs_.ff2;
+    float a1 = coeffs_.fb1, a2 = coeffs_.fb2;
+    float z1 = z1_, z2 = z2_;
+
+    size_t i = 0;
+    if (ramp_) {
+      const size_t ramp = (ramp_ < frames) ? ramp_ : frames;
+      const float db0 = delta_.ff0, db1 = delta_.ff1, db2 = delta_.ff2;
+      const float da1 = delta_.fb1, da2 = delta_.fb2;
+      for (; i < ramp; ++i) {
+        b0 += db0;
+        b1 += db1;
+        b2 += db2;
+        a1 += da1;
+        a2 += da2;
+        const float xn = x[i];
+        const float yn = b0 * xn + z1;
+        z1 = b1 * xn + z2 - a1 * yn;
+        z2 = b2 * xn - a2 * yn;
+        y[i] = yn;
+      }
+      ramp_ -= ramp;
+      if (ramp_ == 0) {
+        // Note: snap to target to avoid accumulating rounding errors
+        b0 = target_.ff0;
+        b1 = target_.ff1;
+        b2 = target_.ff2;
+        a1 = target_.fb1;
+        a2 = target_.fb2;
+      }
+      coeffs_.ff0 = b0;
+      coeffs_.ff1 = b1;
+      coeffs_.ff2 = b2;
+      coeffs_.fb1 = a1;
+      coeffs_.fb2 = a2;
+    }
+
+    for (; i < frames; ++i) {
+      const float xn = x[i];
+      const float yn = b0 * xn + z1;
+      z1 = b1 * xn + z2 - a1 * yn;
+      z2 = b2 * xn - a2 * yn;
+      y[i] = yn;
+    }
+
+    z1_ = z1;
+    z2_ = z2;
+  }
+
+  /**
+   * Filter one sample.
+   */
+  fast_inline float process(const float xn) {
+    float yn;
+    process(&xn, &yn, 1);
+    return yn;
+  }
+
+ private:
+  BiQuad::Coeffs coeffs_, target_, delta_;
+  float z1_, z2_;
+  size_t ramp_;
+};
+
+}  // namespace dsp
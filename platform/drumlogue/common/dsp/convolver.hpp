@@ -0,0 +1,248 @@
+#pragma once
+/**
+ * @file convolver.hpp
+ * @brief Low latency partitioned convolution
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "attributes.h"
+#include "fft.hpp"
+#include "sample_wrapper.h"
+
+namespace dsp {
+
+/**
+ * Uniformly partitioned convolution with zero latency, e.g. for convolution
+ * reverbs and cabinet simulation.
+ *
+ * The first Partition taps of the impulse response are applied with a
+ * direct form FIR. The remaining taps are split into partitions of
+ * Partition taps, convolved by overlap-save in the frequency domain with a
+ * frequency domain delay line of input spectra. Its output for one input
+ * block is used during the next block, which the offset of the tail taps
+ * compensates exactly.
+ *
+ * Only the newest input spectrum is needed at the end of a block: its
+ * forward transform, its product with the first tail partition and the
+ * inverse transform run once every Partition samples, independently of the
+ * render buffer size and of the impulse response length. The products of
+ * the other partitions with the older spectra are accumulated in slices
+ * over the samples of the block, so the cost of a render call is
+ * spread evenly. All memory is provided by the caller at init().
+ *
+ * @tparam Partition Partition size in samples, power of two, at least 16
+ */
+template <size_t Partition = 128>
+class Convolver {
+ public:
+  /** FFT size */
+  static constexpr size_t kFftSize = 2 * Partition;
+
+  Convolver(void)
+      : spectra_(nullptr),
+        fdl_(nullptr),
+        max_partitions_(0),
+        partitions_(0),
+        fdl_idx_(0),
+        fill_(0),
+        head_idx_(0),
+        next_partition_(1) {}
+
+  /**
+   * Memory needed for an impulse response length.
+   *
+   * @param ir_frames Maximum impulse response length in samples
+   * @return Size in floats
+   */
+  static constexpr size_t memorySize(size_t ir_frames) { return 2 * kFftSize * tailPartitions(ir_frames); }
+
+  /**
+   * Attach memory for the impulse response and input spectra.
+   *
+   * @param ram Buffer of memorySize(max_ir_frames) floats, 16 byte aligned
+   * @param max_ir_frames Maximum impulse response length in samples
+   */
+  inline void init(float *ram, size_t max_ir_frames) {
+    max_partitions_ = tailPartitions(max_ir_frames);
+    spectra_ = ram;
+    fdl_ = ram + kFftSize * max_partitions_;
+    partitions_ = 0;
+    std::memset(head_, 0, sizeof(head_));
+    reset();
+  }
+
+  /**
+   * Clear the convolution state, keeps the impulse response.
+   */
+  inline void reset(void) {
+    if (fdl_) std::memset(fdl_, 0, kFftSize * max_partitions_ * sizeof(float));
+    std::memset(history_, 0, sizeof(history_));
+    std::memset(input_, 0, sizeof(input_));
+    std::memset(tail_, 0, sizeof(tail_));
+    std::memset(acc_, 0, sizeof(acc_));
+    fdl_idx_ = 0;
+    fill_ = 0;
+    head_idx_ = 0;
+    next_partition_ = 1;
+  }
+
+  /**
+   * Set the impulse response, truncated to the length given at init().
+   *
+   * Transforms every partition, call from initialization or while the unit
+   * is suspended, not concurrently with process().
+   *
+   * @param ir Impulse response samples
+   * @param frames Impulse response length in samples
+   * @param stride Distance between samples, e.g. channel count of an interleaved buffer
+   */
+  inline void setImpulseResponse(const float *ir, size_t frames, size_t stride = 1) {
+    // Note: head taps are stored reversed to match the oldest to newest history window
+    for (size_t k = 0; k < Partition; ++k) head_[Partition - 1 - k] = (k < frames) ? ir[k * stride] : 0.f;
+
+    partitions_ = tailPartitions(frames);
+    if (partitions_ > max_partitions_) partitions_ = max_partitions_;
+
+    // Note: 1/N scaling of the unscaled inverse transform is folded into the spectra
+    const float scale = 1.f / kFftSize;
+    for (size_t k = 0; k < partitions_; ++k) {
+      float *h = spectra_ + kFftSize * k;
+      for (size_t i = 0; i < kFftSize; ++i) {
+        const size_t t = Partition + k * Partition + i;
+        h[i] = (i < Partition && t < frames) ? ir[t * stride] * scale : 0.f;
+      }
+      fft_.forward(h);
+    }
+    reset();
+  }
+
+  /**
+   * Set the impulse response from a sample, e.g. obtained with the runtime's get_sample(bank, index).
+   *
+   * @param sample Sample wrapper, ignored if null or empty
+   * @param channel Channel of the sample to use
+   */
+  inline void setImpulseResponse(const sample_wrapper_t *sample, uint8_t channel = 0) {
+    if (!sample || !sample->sample_ptr || sample->frames == 0 || sample->channels == 0) return;
+    if (channel >= sample->channels) channel = sample->channels - 1;
+    setImpulseResponse(sample->sample_ptr + channel, sample->frames, sample->channels);
+  }
+
+  /**
+   * Convolve a buffer with the impulse response.
+   *
+   * @param in Input samples
+   * @param out Output samples, may be the same as in
+   * @param frames Number of samples
+   * @param stride Distance between samples in both buffers, e.g. 2 for one channel of an interleaved stereo buffer
+   */
+  fast_inline void process(const float *in, float *out, size_t frames, size_t stride = 1) {
+    for (size_t n = 0; n < frames; ++n, in += stride, out += stride) {
+      const float x = *in;
+
+      // Note: history is stored twice so that the last Partition samples are always contiguous
+      history_[head_idx_] = history_[head_idx_ + Partition] = x;
+      const float y = dot(head_, &history_[head_idx_ + 1]) + tail_[fill_];
+      head_idx_ = (head_idx_ + 1) & (Partition - 1);
+
+      input_[Partition + fill_] = x;
+      accumulatePartitions(++fill_);
+      if (fill_ == Partition) {
+        processPartitions();
+        fill_ = 0;
+      }
+      *out = y;
+    }
+  }
+
+ private:
+  static constexpr size_t tailPartitions(size_t ir_frames) {
+    return (ir_frames > Partition) ? (ir_frames - 1) / Partition : 0;
+  }
+
+  static fast_inline float dot(const float *a, const float *b) {
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    float32x4_t acc = vdupq_n_f32(0.f);
+    for (size_t k = 0; k < Partition; k += 4) acc = vmlaq_f32(acc, vld1q_f32(&a[k]), vld1q_f32(&b[k]));
+    const float32x2_t s = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    return vget_lane_f32(s, 0) + vget_lane_f32(s, 1);
+#else
+    float acc = 0.f;
+    for (size_t k = 0; k < Partition; ++k) acc += a[k] * b[k];
+    return acc;
+#endif
+  }
+
+  /**
+   * Products of the partitions after the first one, up to the share of the block filled so far.
+   *
+   * @param fill Samples of the current block received, in [1, Partition]
+   */
+  fast_inline void accumulatePartitions(size_t fill) {
+    // Note: all of them once the block is complete, before processPartitions()
+    const size_t target = 1 + ((partitions_ > 1 ? partitions_ - 1 : 0) * fill) / Partition;
+    if (next_partition_ >= target) return;
+
+    // Note: partition k pairs with the input spectrum k blocks old, the newest being added at the end of the block
+    size_t idx = fdl_idx_ + next_partition_ - 1;
+    if (idx >= partitions_) idx -= partitions_;
+    for (; next_partition_ < target; ++next_partition_) {
+      RealFft<kFftSize>::multiplyAccumulate(acc_, fdl_ + kFftSize * idx, spectra_ + kFftSize * next_partition_);
+      idx = (idx + 1 == partitions_) ? 0 : idx + 1;
+    }
+  }
+
+  /**
+   * Overlap-save update of the tail output, once every Partition samples.
+   */
+  inline void processPartitions(void) {
+    if (partitions_ == 0) {
+      std::memmove(input_, input_ + Partition, Partition * sizeof(float));
+      return;
+    }
+
+    // Input spectrum of the last two blocks into the delay line
+    fdl_idx_ = (fdl_idx_ == 0) ? partitions_ - 1 : fdl_idx_ - 1;
+    fft_.forward(input_, fdl_ + kFftSize * fdl_idx_);
+    std::memmove(input_, input_ + Partition, Partition * sizeof(float));
+
+    // Note: the other partitions were accumulated during the block
+    RealFft<kFftSize>::multiplyAccumulate(acc_, fdl_ + kFftSize * fdl_idx_, spectra_);
+
+    fft_.inverse(acc_);
+    std::memcpy(tail_, acc_ + Partition, Partition * sizeof(float));
+    std::memset(acc_, 0, sizeof(acc_));
+    next_partition_ = 1;
+  }
+
+  RealFft<kFftSize> fft_;
+
+  // Note: external memory, packed partition spectra followed by the packed input spectra delay line
+  float *spectra_;
+  float *fdl_;
+  size_t max_partitions_;
+  size_t partitions_;
+  size_t fdl_idx_;
+  size_t fill_;
+  size_t head_idx_;
+  size_t next_partition_;
+
+  float head_[Partition] __attribute__((aligned(16)));
+  float history_[2 * Partition] __attribute__((aligned(16)));
+  float input_[kFftSize] __attribute__((aligned(16)));
+  float tail_[Partition] __attribute__((aligned(16)));
+  // Note: spectrum of the next tail block, accumulated over the current block
+  float acc_[kFftSize] __attribute__((aligned(16)));
+};
+
+}  // namespace dsp
@@ -0,0 +1,533 @@
+#pragma once
+/**
+ * @file delayline.hpp
+ * @brief Basic delay lines with block processing
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "attributes.h"
+
+namespace dsp {
+
+/**
+ * Fractional delay interpolation modes, see DelayLine::readInterp().
+ */
+enum DelayInterp {
+  k_delay_interp_linear = 0,  // 2-point linear, same as readFrac()
+  k_delay_interp_hermite,     // 4-point 3rd order Hermite (Catmull-Rom)
+  k_delay_interp_lagrange3,   // 4-point 3rd order Lagrange
+  k_delay_interp_allpass      // 1st order allpass, stateful, one modulated tap per line
+};
+
+/**
+ * Weights of a 4-point interpolator for the samples at offsets pos-1, pos, pos+1 and pos+2.
+ *
+ * @param f Fractional part of the position
+ * @param w Destination for the 4 weights
+ */
+template <DelayInterp I>
+fast_inline void delay_interp_weights(const float f, float *w) {
+  if (I == k_delay_interp_hermite) {
+    const float f2 = f * f;
+    const float f3 = f2 * f;
+    w[0] = 0.5f * (-f3 + 2.f * f2 - f);
+    w[1] = 0.5f * (3.f * f3 - 5.f * f2) + 1.f;
+    w[2] = 0.5f * (-3.f * f3 + 4.f * f2 + f);
+    w[3] = 0.5f * (f3 - f2);
+  } else if (I == k_delay_interp_lagrange3) {
+    const float fp1 = f + 1.f;
+    const float fm1 = f - 1.f;
+    const float fm2 = f - 2.f;
+    w[0] = -f * fm1 * fm2 * (1.f / 6.f);
+    w[1] = fp1 * fm1 * fm2 * 0.5f;
+    w[2] = -fp1 * f * fm2 * 0.5f;
+    w[3] = fp1 * f * fm1 * (1.f / 6.f);
+  } else {
+    w[0] = w[3] = 0.f;
+    w[1] = 1.f - f;
+    w[2] = f;
+  }
+}
+
+/**
+ * Allpass interpolator coefficient for a fractional position.
+ *
+ * @param base Integer part of the position, adjusted so that the fractional delay is in [0.5, 1.5)
+ * @param frac Fractional part of the position
+ * @return Allpass coefficient, in (-0.2, 0.34]
+ */
+fast_inline float delay_interp_allpass_coeff(uint32_t &base, float frac) {
+  // Note: keeps the pole away from -1, where the allpass rings at Nyquist
+  if (frac < 0.5f) {
+    --base;
+    frac += 1.f;
+  }
+  return (1.f - frac) / (1.f + frac);
+}
+
+/**
+ * Single channel delay line over an externally provided power of two buffer.
+ *
+ * Samples are written at decreasing indices, read(pos) returns the sample
+ * written pos writes ago, read(1) being the most recent. Per-sample methods
+ * match the dsp::DelayLine of the prologue, minilogue xd and NTS-1 digital
+ * SDKs.
+ *
+ * Block methods process a whole buffer with at most two contiguous segments
+ * per call, split where the line wraps around, instead of masking every
+ * index.
+ */
+class DelayLine {
+ public:
+  DelayLine(void) : line_(nullptr), frac_z_(0), ap_z_(0), size_(0), mask_(0), write_idx_(0) {}
+
+  /**
+   * @param ram Backing buffer
+   * @param line_size Size of backing buffer in samples, must be a power of two
+   */
+  DelayLine(float *ram, size_t line_size)
+      : line_(ram), frac_z_(0), ap_z_(0), size_(line_size), mask_(line_size - 1), write_idx_(0) {}
+
+  /**
+   * Zero clear the whole delay line.
+   */
+  inline void clear(void) { std::memset(line_, 0, size_ * sizeof(float)); }
+
+  /**
+   * Set the memory area to use as backing buffer for the delay line.
+   *
+   * @param ram Backing buffer
+   * @param line_size Size of backing buffer in samples, rounded down to a power of two
+   */
+  inline void setMemory(float *ram, size_t line_size) {
+    line_ = ram;
+    size_ = 1;
+    while (size_ <= (line_size >> 1)) size_ <<= 1;
+    mask_ = size_ - 1;
+    write_idx_ = 0;
+  }
+
+  /**
+   * @return Size of the delay line in samples
+   */
+  inline size_t size(void) const { return size_; }
+
+  /**
+   * Write a single sample to the head of the delay line.
+   */
+  fast_inline void write(const float s) { line_[(write_idx_--) & mask_] = s; }
+
+  /**
+   * Read a single sample at given position from current write index.
+   */
+  fast_inline float read(const uint32_t pos) const { return line_[(write_idx_ + pos) & mask_]; }
+
+  /**
+   * Read a linearly interpolated sample at a fractional position from current write index.
+   */
+  fast_inline float readFrac(const float pos) const {
+    const uint32_t base = static_cast<uint32_t>(pos);
+    const float frac = pos - base;
+    const float s0 = read(base);
+    const float s1 = read(base + 1);
+    return s0 + frac * (s1 - s0);
+  }
+
+  /**
+   * Read a sample at given position, interpolated with the sample of the previous call.
+   */
+  fast_inline float readFracz(const uint32_t pos, const float frac) {
+    const float s0 = read(pos);
+    const float y = s0 + frac * (frac_z_ - s0);
+    frac_z_ = s0;
+    return y;
+  }
+
+  /**
+   * Write a block of samples, equivalent to calling write() for each sample in order.
+   *
+   * @param src Samples to write
+   * @param frames Number of samples
+   */
+  fast_inline void writeBlock(const float *__restrict__ src, size_t frames) {
+    uint32_t idx = write_idx_ & mask_;
+    write_idx_ -= frames;
+    while (frames) {
+      const size_t seg = (frames < idx + 1) ? frames : idx + 1;
+      float *__restrict__ dst = line_ + idx;
+      size_t i = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+      for (; i + 4 <= seg; i += 4, src += 4, dst -= 4) vst1q_f32(dst - 3, reverse(vld1q_f32(src)));
+#endif
+      for (; i < seg; ++i) *(dst--) = *(src++);
+      frames -= seg;
+      idx = mask_;
+    }
+  }
+
+  /**
+   * Read a block of samples at a fixed position, following a writeBlock() of the same size.
+   *
+   * dst[i] is the sample read(pos) would have returned right after write() of
+   * the i-th sample of the block.
+   *
+   * @param dst Destination buffer
+   * @param pos Offset from write index, pos + frames must not exceed the line size
+   * @param frames Number of samples
+   */
+  fast_inline void readBlock(float *__restrict__ dst, const uint32_t pos, size_t frames) const {
+    uint32_t idx = (write_idx_ + frames - 1 + pos) & mask_;
+    while (frames) {
+      const size_t seg = (frames < idx + 1) ? frames : idx + 1;
+      const float *__restrict__ src = line_ + idx;
+      size_t i = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+      for (; i + 4 <= seg; i += 4, src -= 4, dst += 4) vst1q_f32(dst, reverse(vld1q_f32(src - 3)));
+#endif
+      for (; i < seg; ++i) *(dst++) = *(src--);
+      frames -= seg;
+      idx = mask_;
+    }
+  }
+
+  /**
+   * Read a block of linearly interpolated samples at a fixed fractional
+   * position, following a writeBlock() of the same size.
+   *
+   * dst[i] is the sample readFrac(pos) would have returned right after
+   * write() of the i-th sample of the block.
+   *
+   * @param dst Destination buffer
+   * @param pos Offset from write index, pos + frames + 1 must not exceed the line size
+   * @param frames Number of samples
+   */
+  fast_inline void readFracBlock(float *__restrict__ dst, const float pos, size_t frames) const {
+    const uint32_t base = static_cast<uint32_t>(pos);
+    const float frac = pos - base;
+    uint32_t idx = (write_idx_ + frames - 1 + base) & mask_;
+    // Note: consecutive outputs step down by one sample, so s1 of each output is s0 of the previous one
+    float s1 = line_[(idx + 1) & mask_];
+    while (frames) {
+      const size_t seg = (frames < idx + 1) ? frames : idx + 1;
+      const float *__restrict__ src = line_ + idx;
+      size_t i = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+      for (; i + 4 <= seg; i += 4, src -= 4, dst += 4) {
+        // Note: s0 lanes hold src[-3..0], s1 lanes the following sample of each
+        const float32x4_t s0v = vld1q_f32(src - 3);
+        const float32x4_t s1v = vextq_f32(s0v, vdupq_n_f32(s1), 1);
+        vst1q_f32(dst, reverse(vmlaq_n_f32(s0v, vsubq_f32(s1v, s0v), frac)));
+        s1 = vgetq_lane_f32(s0v, 0);
+      }
+#endif
+      for (; i < seg; ++i) {
+        const float s0 = *(src--);
+        *(dst++) = s0 + frac * (s1 - s0);
+        s1 = s0;
+      }
+      frames -= seg;
+      idx = mask_;
+    }
+  }
+
+  /**
+   * Read a sample at a fractional position from current write index, with selectable interpolation.
+   *
+   * @tparam I Interpolation mode
+   * @param pos Offset from write index, at least 2 for modes other than linear
+   */
+  template <DelayInterp I>
+  fast_inline float readInterp(const float pos) {
+    if (I == k_delay_interp_linear) return readFrac(pos);
+    uint32_t base = static_cast<uint32_t>(pos);
+    const float frac = pos - base;
+    if (I == k_delay_interp_allpass) {
+      const float eta = delay_interp_allpass_coeff(base, frac);
+      ap_z_ = read(base + 1) + eta * (read(base) - ap_z_);
+      return ap_z_;
+    }
+    float w[4];
+    delay_interp_weights<I>(frac, w);
+    return w[0] * read(base - 1) + w[1] * read(base) + w[2] * read(base + 1) + w[3] * read(base + 2);
+  }
+
+  /**
+   * Read a block of interpolated samples at a fixed fractional position,
+   * following a writeBlock() of the same size.
+   *
+   * dst[i] is the sample readInterp<I>(pos) would have returned right after
+   * write() of the i-th sample of the block.
+   *
+   * @tparam I Interpolation mode
+   * @param dst Destination buffer
+   * @param pos Offset from write index, at least 2 for modes other than linear,
+   *            pos + frames + 2 must not exceed the line size
+   * @param frames Number of samples
+   */
+  template <DelayInterp I>
+  fast_inline void readInterpBlock(float *__restrict__ dst, const float pos, size_t frames) {
+    if (I == k_delay_interp_linear) {
+      readFracBlock(dst, pos, frames);
+      return;
+    }
+    uint32_t base = static_cast<uint32_t>(pos);
+    const float frac = pos - base;
+    float w[4] = {0, 0, 0, 0};
+    float eta = 0;
+    if (I == k_delay_interp_allpass)
+      eta = delay_interp_allpass_coeff(base, frac);
+    else
+      delay_interp_weights<I>(frac, w);
+
+    // Note: the 4-point window slides down by one sample per output, only its newest sample is loaded
+    uint32_t idx = (write_idx_ + frames - 2 + base) & mask_;
+    float x0 = line_[(idx + 1) & mask_];
+    float x1 = line_[(idx + 2) & mask_];
+    float x2 = line_[(idx + 3) & mask_];
+    float z = ap_z_;
+    while (frames) {
+      const size_t seg = (frames < idx + 1) ? frames : idx + 1;
+      const float *__restrict__ src = line_ + idx;
+      size_t i = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+      if (I != k_delay_interp_allpass && seg >= 4) {
+        // Note: lanes hold 4 consecutive outputs, window vectors are shifted views of the last 8 samples
+        float32x4_t prev = {0.f, x2, x1, x0};
+        for (; i + 4 <= seg; i += 4, src -= 4, dst += 4) {
+          const float32x4_t cur = reverse(vld1q_f32(src - 3));
+          float32x4_t y = vmulq_n_f32(cur, w[0]);
+          y = vmlaq_n_f32(y, vextq_f32(prev, cur, 3), w[1]);
+          y = vmlaq_n_f32(y, vextq_f32(prev, cur, 2), w[2]);
+          y = vmlaq_n_f32(y, vextq_f32(prev, cur, 1), w[3]);
+          vst1q_f32(dst, y);
+          prev = cur;
+        }
+        x2 = vgetq_lane_f32(prev, 1);
+        x1 = vgetq_lane_f32(prev, 2);
+        x0 = vgetq_lane_f32(prev, 3);
+      }
+#endif
+      for (; i < seg; ++i) {
+        const float xm1 = *(src--);
+        if (I == k_delay_interp_allpass)
+          *(dst++) = z = x1 + eta * (x0 - z);
+        else
+          *(dst++) = w[0] * xm1 + w[1] * x0 + w[2] * x1 + w[3] * x2;
+        x2 = x1;
+        x1 = x0;
+        x0 = xm1;
+      }
+      frames -= seg;
+      idx = mask_;
+    }
+    ap_z_ = z;
+  }
+
+ private:
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+  static fast_inline float32x4_t reverse(float32x4_t v) {
+    v = vrev64q_f32(v);
+    return vcombine_f32(vget_high_f32(v), vget_low_f32(v));
+  }
+#endif
+
+  float *line_;
+  float frac_z_;
+  float ap_z_;
+  size_t size_;
+  size_t mask_;
+  uint32_t write_idx_;
+};
+
+/**
+ * Multi-channel delay line with interleaved frames and one shared write index.
+ *
+ * Frames are stored contiguously with a stride padded to a multiple of four
+ * floats (two for stereo), so on NEON targets a frame is read or written
+ * with aligned vector accesses instead of one masked access per channel.
+ * Positions follow DelayLine: read(1, ..) returns the most recent frame.
+ *
+ * Generalizes the dsp::DualDelayLine of the prologue, minilogue xd and
+ * NTS-1 digital SDKs to N channels, e.g. for FDN reverbs or the 4-channel
+ * input of master effects.
+ *
+ * @tparam Channels Number of channels
+ */
+template <size_t Channels>
+class MultiDelayLine {
+ public:
+  static_assert(Channels > 0, "At least one channel is required.");
+
+  /** Floats per stored frame */
+  static constexpr size_t kStride = (Channels <= 2) ? Channels : ((Channels + 3) & ~static_cast<size_t>(3));
+
+  MultiDelayLine(void) : line_(nullptr), size_(0), mask_(0), write_idx_(0) {}
+
+  /**
+   * @param ram Backing buffer of line_size * kStride floats, 16 byte aligned
+   * @param line_size Size of backing buffer in frames, must be a power of two
+   */
+  MultiDelayLine(float *ram, size_t line_size)
+      : line_(ram), size_(line_size), mask_(line_size - 1), write_idx_(0) {}
+
+  /**
+   * Zero clear the whole delay line.
+   */
+  inline void clear(void) { std::memset(line_, 0, size_ * kStride * sizeof(float)); }
+
+  /**
+   * Set the memory area to use as backing buffer for the delay line.
+   *
+   * @param ram Backing buffer of line_size * kStride floats, 16 byte aligned
+   * @param line_size Size of backing buffer in frames, rounded down to a power of two
+   */
+  inline void setMemory(float *ram, size_t line_size) {
+    line_ = ram;
+    size_ = 1;
+    while (size_ <= (line_size >> 1)) size_ <<= 1;
+    mask_ = size_ - 1;
+    write_idx_ = 0;
+  }
+
+  /**
+   * @return Size of the delay line in frames
+   */
+  inline size_t size(void) const { return size_; }
+
+  /**
+   * Write a frame to the head of the delay line.
+   *
+   * @param frame Channels samples
+   */
+  fast_inline void write(const float *frame) {
+    copyFrame(line_ + ((write_idx_--) & mask_) * kStride, frame);
+  }
+
+  /**
+   * Direct access to a stored frame, kStride floats, 8 or 16 byte aligned.
+   *
+   * @param pos Offset from write index
+   */
+  fast_inline const float *frame(const uint32_t pos) const { return line_ + ((write_idx_ + pos) & mask_) * kStride; }
+
+  /**
+   * Read a frame at given position from current write index.
+   *
+   * @param pos Offset from write index
+   * @param frame Destination for Channels samples
+   */
+  fast_inline void read(const uint32_t pos, float *frame) const { copyFrame(frame, this->frame(pos)); }
+
+  /**
+   * Read a linearly interpolated frame at a fractional position from current write index.
+   *
+   * @param pos Offset from write index
+   * @param frame Destination for Channels samples
+   */
+  fast_inline void readFrac(const float pos, float *frame) const {
+    const uint32_t base = static_cast<uint32_t>(pos);
+    const float frac = pos - base;
+    const float *__restrict__ p0 = this->frame(base);
+    const float *__restrict__ p1 = this->frame(base + 1);
+    size_t ch = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; ch + 4 <= Channels; ch += 4) {
+      const float32x4_t s0 = vld1q_f32(p0 + ch);
+      vst1q_f32(frame + ch, vmlaq_n_f32(s0, vsubq_f32(vld1q_f32(p1 + ch), s0), frac));
+    }
+#endif
+    for (; ch < Channels; ++ch) frame[ch] = p0[ch] + frac * (p1[ch] - p0[ch]);
+  }
+
+  /**
+   * Read each channel at its own position, e.g. the taps of a feedback delay network.
+   *
+   * @param pos Channels offsets from write index
+   * @param frame Destination for Channels samples
+   */
+  fast_inline void readTaps(const uint32_t *pos, float *frame) const {
+    for (size_t ch = 0; ch < Channels; ++ch) frame[ch] = line_[((write_idx_ + pos[ch]) & mask_) * kStride + ch];
+  }
+
+  /**
+   * Read each channel at its own fractional position with linear interpolation, e.g. modulated FDN taps.
+   *
+   * @param pos Channels offsets from write index
+   * @param frame Destination for Channels samples
+   */
+  fast_inline void readTapsFrac(const float *pos, float *frame) const {
+    for (size_t ch = 0; ch < Channels; ++ch) {
+      const uint32_t base = static_cast<uint32_t>(pos[ch]);
+      const float frac = pos[ch] - base;
+      const float s0 = line_[((write_idx_ + base) & mask_) * kStride + ch];
+      const float s1 = line_[((write_idx_ + base + 1) & mask_) * kStride + ch];
+      frame[ch] = s0 + frac * (s1 - s0);
+    }
+  }
+
+  /**
+   * Write a block of interleaved frames, equivalent to calling write() for each frame in order.
+   *
+   * @param src Interleaved frames, Channels samples each
+   * @param frames Number of frames
+   */
+  fast_inline void writeBlock(const float *__restrict__ src, size_t frames) {
+    uint32_t idx = write_idx_ & mask_;
+    write_idx_ -= frames;
+    while (frames) {
+      const size_t seg = (frames < idx + 1) ? frames : idx + 1;
+      float *__restrict__ dst = line_ + idx * kStride;
+      for (size_t i = 0; i < seg; ++i, src += Channels, dst -= kStride) copyFrame(dst, src);
+      frames -= seg;
+      idx = mask_;
+    }
+  }
+
+  /**
+   * Read a block of interleaved frames at a fixed position, following a writeBlock() of the same size.
+   *
+   * dst frame i is the frame read(pos, ..) would have returned right after
+   * write() of the i-th frame of the block.
+   *
+   * @param dst Interleaved destination, Channels samples per frame
+   * @param pos Offset from write index, pos + frames must not exceed the line size
+   * @param frames Number of frames
+   */
+  fast_inline void readBlock(float *__restrict__ dst, const uint32_t pos, size_t frames) const {
+    uint32_t idx = (write_idx_ + frames - 1 + pos) & mask_;
+    while (frames) {
+      const size_t seg = (frames < idx + 1) ? frames : idx + 1;
+      const float *__restrict__ src = line_ + idx * kStride;
+      for (size_t i = 0; i < seg; ++i, src -= kStride, dst += Channels) copyFrame(dst, src);
+      frames -= seg;
+      idx = mask_;
+    }
+  }
+
+ private:
+  static fast_inline void copyFrame(float *__restrict__ dst, const float *__restrict__ src) {
+    size_t ch = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; ch + 4 <= Channels; ch += 4) vst1q_f32(dst + ch, vld1q_f32(src + ch));
+    for (; ch + 2 <= Channels; ch += 2) vst1_f32(dst + ch, vld1_f32(src + ch));
+#endif
+    for (; ch < Channels; ++ch) dst[ch] = src[ch];
+  }
+
+  float *line_;
+  size_t size_;
+  size_t mask_;
+  uint32_t write_idx_;
+};
+
+}  // namespace dsp
@@ -0,0 +1,474 @@
+#pragma once
+/**
+ * @file envelope.hpp
+ * @brief ADSR envelope generators rendering whole blocks
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "attributes.h"
+
+namespace dsp {
+
+/**
+ * Envelope stages.
+ */
+enum AdsrStage {
+  k_adsr_idle = 0U,
+  k_adsr_attack,
+  k_adsr_decay,
+  k_adsr_sustain,
+  k_adsr_release
+};
+
+/**
+ * ADSR timing, and the closed form of each stage.
+ *
+ * Every stage is an exponential segment y[n] = target + (y[0] - target) * mult^n
+ * approaching a target set beyond the stage end level, so that the end is
+ * reached in a finite, precomputed number of samples. Attack aims above 1 for
+ * the familiar convex analog shape, decay and release aim slightly below
+ * their end levels. Sustain and idle are constant segments of unbounded length.
+ */
+class AdsrParams {
+ public:
+  /** Segment length of the unbounded sustain and idle stages */
+  static constexpr uint32_t kHold = 0xFFFFFFFFU;
+
+  explicit AdsrParams(float samplerate = 48000.f)
+      : samplerate_(samplerate), attack_(0.01f), decay_(0.1f), sustain_(1.f), release_(0.1f) {
+    update();
+  }
+
+  /**
+   * @param samplerate Sample rate in Hz
+   */
+  inline void setSampleRate(float samplerate) {
+    samplerate_ = samplerate;
+    update();
+  }
+
+  /**
+   * @param seconds Duration of a full scale attack, from 0 to 1
+   */
+  inline void setAttack(float seconds) {
+    attack_ = seconds;
+    attack_mult_ = multiplier(seconds, kAttackOvershoot);
+  }
+
+  /**
+   * @param seconds Duration of a full scale decay, from 1 to a sustain level of 0
+   */
+  inline void setDecay(float seconds) {
+    decay_ = seconds;
+    decay_mult_ = multiplier(seconds, kDecayUndershoot);
+  }
+
+  /**
+   * @param level Sustain level in [0, 1]
+   */
+  inline void setSustain(float level) { sustain_ = (level < 0.f) ? 0.f : (level > 1.f) ? 1.f : level; }
+
+  /**
+   * @param seconds Duration of a full scale release, from 1 to 0
+   */
+  inline void setRelease(float seconds) {
+    release_ = seconds;
+    release_mult_ = multiplier(seconds, kDecayUndershoot);
+  }
+
+  inline float getSustain(void) const { return sustain_; }
+
+  /**
+   * Level at which a stage ends.
+   */
+  inline float endLevel(AdsrStage stage) const {
+    switch (stage) {
+      case k_adsr_attack:
+        return 1.f;
+      case k_adsr_decay:
+      case k_adsr_sustain:
+        return sustain_;
+      default:
+        return 0.f;
+    }
+  }
+
+  /**
+   * Closed form of a stage started at a given level.
+   *
+   * @param stage Stage
+   * @param level Start level
+   * @param target Segment target
+   * @param mult Segment multiplier per sample
+   * @return Number of samples until the end level is reached, 0 if already reached, kHold for unbounded stages
+   */
+  inline uint32_t segment(AdsrStage stage, float level, float &target, float &mult) const {
+    switch (stage) {
+      case k_adsr_attack:
+        target = 1.f + kAttackOvershoot;
+        mult = attack_mult_;
+        return length(level, 1.f, target, mult);
+      case k_adsr_decay:
+        target = sustain_ - kDecayUndershoot;
+        mult = decay_mult_;
+        return length(level, sustain_, target, mult);
+      case k_adsr_release:
+        target = -kDecayUndershoot;
+        mult = release_mult_;
+        return length(level, 0.f, target, mult);
+      case k_adsr_sustain:
+        // Note: after a sustain change, glide to the new level at the decay rate before holding
+        if (fabsf(level - sustain_) > kDecayUndershoot) {
+          target = (level > sustain_) ? sustain_ - kDecayUndershoot : sustain_ + kDecayUndershoot;
+          mult = decay_mult_;
+          return length(level, sustain_, target, mult);
+        }
+        target = sustain_;
+        mult = 1.f;
+        return kHold;
+      default:
+        target = 0.f;
+        mult = 1.f;
+        return kHold;
+    }
+  }
+
+  /**
+   * Stage following the end of a stage.
+   */
+  static inline AdsrStage next(AdsrStage stage) {
+    switch (stage) {
+      case k_adsr_attack:
+        return k_adsr_decay;
+      case k_adsr_decay:
+      case k_adsr_sustain:
+        return k_adsr_sustain;
+      default:
+        return k_adsr_idle;
+    }
+  }
+
+ private:
+  static constexpr float kAttackOvershoot = 0.3f;
+  static constexpr float kDecayUndershoot = 1e-4f;
+
+  inline void update(void) {
+    setAttack(attack_);
+    setDecay(decay_);
+    setRelease(release_);
+  }
+
+  /**
+   * Multiplier of a full scale segment of the given duration, with the target ratio beyond the end level.
+   */
+  inline float multiplier(float seconds, float ratio) const {
+    float samples = seconds * samplerate_;
+    if (samples < 1.f) samples = 1.f;
+    return expf(-logf((1.f + ratio) / ratio) / samples);
+  }
+
+  static inline uint32_t length(float from, float to, float target, float mult) {
+    const float r = (to - target) / (from - target);
+    if (!(r > 0.f && r < 1.f)) return 0;
+    const float n = ceilf(logf(r) / logf(mult));
+    return (n < static_cast<float>(kHold - 1)) ? static_cast<uint32_t>(n) : kHold - 1;
+  }
+
+  float samplerate_;
+  float attack_;
+  float decay_;
+  float sustain_;
+  float release_;
+  float attack_mult_;
+  float decay_mult_;
+  float release_mult_;
+};
+
+/**
+ * ADSR envelope generator.
+ *
+ * process() renders a block as a few closed form exponential segments,
+ * branching only where a stage ends. Gates restart the attack from the
+ * current level, so retriggers do not click.
+ */
+class Adsr {
+ public:
+  explicit Adsr(float samplerate = 48000.f) : params_(samplerate) { reset(); }
+
+  inline void setSampleRate(float samplerate) {
+    params_.setSampleRate(samplerate);
+    refresh();
+  }
+
+  /** @param seconds Full scale attack time */
+  inline void setAttack(float seconds) {
+    params_.setAttack(seconds);
+    refresh();
+  }
+
+  /** @param seconds Full scale decay time */
+  inline void setDecay(float seconds) {
+    params_.setDecay(seconds);
+    refresh();
+  }
+
+  /** @param level Sustain level in [0, 1] */
+  inline void setSustain(float level) {
+    params_.setSustain(level);
+    refresh();
+  }
+
+  /** @param seconds Full scale release time */
+  inline void setRelease(float seconds) {
+    params_.setRelease(seconds);
+    refresh();
+  }
+
+  /**
+   * Return to idle at level 0.
+   */
+  inline void reset(void) { enter(k_adsr_idle, 0.f); }
+
+  /**
+   * Start the attack stage from the current level.
+   */
+  inline void gateOn(void) { enter(k_adsr_attack, level()); }
+
+  /**
+   * Start the release stage from the current level.
+   */
+  inline void gateOff(void) {
+    if (stage_ != k_adsr_idle) enter(k_adsr_release, level());
+  }
+
+  inline AdsrStage stage(void) const { return stage_; }
+
+  inline float level(void) const { return target_ + delta_; }
+
+  inline bool isActive(void) const { return stage_ != k_adsr_idle; }
+
+  /**
+   * Render a block of envelope values.
+   *
+   * @param out Destination
+   * @param frames Number of samples
+   */
+  fast_inline void process(float *out, size_t frames) {
+    while (frames > 0) {
+      const uint32_t n = (remaining_ < frames) ? remaining_ : static_cast<uint32_t>(frames);
+      render(out, n);
+      out += n;
+      frames -= n;
+      if (remaining_ != AdsrParams::kHold && (remaining_ -= n) == 0) {
+        // Note: last sample of the stage lands exactly on the end level
+        const float end = params_.endLevel(stage_);
+        out[-1] = end;
+        enter(AdsrParams::next(stage_), end);
+      }
+    }
+  }
+
+ private:
+  inline void enter(AdsrStage stage, float level) {
+    for (;;) {
+      stage_ = stage;
+      remaining_ = params_.segment(stage, level, target_, mult_);
+      delta_ = level - target_;
+      if (remaining_ > 0) return;
+      level = params_.endLevel(stage);
+      stage = AdsrParams::next(stage);
+    }
+  }
+
+  inline void refresh(void) { enter(stage_, level()); }
+
+  /**
+   * n samples of the current segment, vectorized over time with the multiplier raised to the 4th power.
+   */
+  fast_inline void render(float *out, uint32_t n) {
+    const float target = target_;
+    const float mult = mult_;
+    float delta = delta_;
+    uint32_t i = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    if (n >= 4) {
+      const float m2 = mult * mult;
+      const float m4 = m2 * m2;
+      const float32x4_t t = vdupq_n_f32(target);
+      float32x4_t d = {delta * mult, delta * m2, delta * m2 * mult, delta * m4};
+      for (; i + 4 <= n; i += 4) {
+        vst1q_f32(&out[i], vaddq_f32(t, d));
+        delta = vgetq_lane_f32(d, 3);
+        d = vmulq_n_f32(d, m4);
+      }
+    }
+#endif
+    for (; i < n; ++i) {
+      delta *= mult;
+      out[i] = target + delta;
+    }
+    delta_ = delta;
+  }
+
+  AdsrParams params_;
+  AdsrStage stage_;
+  uint32_t remaining_;
+  float target_;
+  float delta_;
+  float mult_;
+};
+
+/**
+ * Four ADSR envelopes sharing their timing, rendered together, e.g. for
+ * voices processed in groups of four.
+ *
+ * Segments of the four lanes run side by side until the first stage end in
+ * any lane, so per sample work is one multiply-add across all lanes.
+ */
+class AdsrQuad {
+ public:
+  explicit AdsrQuad(float samplerate = 48000.f) : params_(samplerate) { reset(); }
+
+  inline void setSampleRate(float samplerate) {
+    params_.setSampleRate(samplerate);
+    refresh();
+  }
+
+  /** @param seconds Full scale attack time */
+  inline void setAttack(float seconds) {
+    params_.setAttack(seconds);
+    refresh();
+  }
+
+  /** @param seconds Full scale decay time */
+  inline void setDecay(float seconds) {
+    params_.setDecay(seconds);
+    refresh();
+  }
+
+  /** @param level Sustain level in [0, 1] */
+  inline void setSustain(float level) {
+    params_.setSustain(level);
+    refresh();
+  }
+
+  /** @param seconds Full scale release time */
+  inline void setRelease(float seconds) {
+    params_.setRelease(seconds);
+    refresh();
+  }
+
+  /**
+   * Return all lanes to idle at level 0.
+   */
+  inline void reset(void) {
+    for (size_t l = 0; l < 4; ++l) enter(l, k_adsr_idle, 0.f);
+  }
+
+  /**
+   * @param lane Lane in [0, 3]
+   */
+  inline void gateOn(size_t lane) { enter(lane, k_adsr_attack, level(lane)); }
+
+  /**
+   * @param lane Lane in [0, 3]
+   */
+  inline void gateOff(size_t lane) {
+    if (stage_[lane] != k_adsr_idle) enter(lane, k_adsr_release, level(lane));
+  }
+
+  inline AdsrStage stage(size_t lane) const { return stage_[lane]; }
+
+  inline float level(size_t lane) const { return target_[lane] + delta_[lane]; }
+
+  inline bool isActive(size_t lane) const { return stage_[lane] != k_adsr_idle; }
+
+  /**
+   * Render a block of envelope values, frame-major.
+   *
+   * @param out Destination, out[4 * n + lane] for frame n, 16 byte aligned
+   * @param frames Number of frames
+   */
+  fast_inline void process(float *out, size_t frames) {
+    while (frames > 0) {
+      uint32_t n = (frames < AdsrParams::kHold) ? static_cast<uint32_t>(frames) : AdsrParams::kHold - 1;
+      for (size_t l = 0; l < 4; ++l)
+        if (remaining_[l] < n) n = remaining_[l];
+
+      render(out, n);
+      float *last = out + 4 * (n - 1);
+      out += 4 * n;
+      frames -= n;
+
+      for (size_t l = 0; l < 4; ++l) {
+        if (remaining_[l] == AdsrParams::kHold || (remaining_[l] -= n) != 0) continue;
+        // Note: last sample of the stage lands exactly on the end level
+        const float end = params_.endLevel(stage_[l]);
+        last[l] = end;
+        enter(l, AdsrParams::next(stage_[l]), end);
+      }
+    }
+  }
+
+ private:
+  inline void enter(size_t lane, AdsrStage stage, float level) {
+    for (;;) {
+      stage_[lane] = stage;
+      remaining_[lane] = params_.segment(stage, level, target_[lane], mult_[lane]);
+      delta_[lane] = level - target_[lane];
+      if (remaining_[lane] > 0) return;
+      level = params_.endLevel(stage);
+      stage = AdsrParams::next(stage);
+    }
+  }
+
+  inline void refresh(void) {
+    for (size_t l = 0; l < 4; ++l) enter(l, stage_[l], level(l));
+  }
+
+  fast_inline void render(float *out, uint32_t n) {
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    const float32x4_t t = vld1q_f32(target_);
+    const float32x4_t m = vld1q_f32(mult_);
+    float32x4_t d = vld1q_f32(delta_);
+    for (uint32_t i = 0; i < n; ++i) {
+      d = vmulq_f32(d, m);
+      vst1q_f32(&out[4 * i], vaddq_f32(t, d));
+    }
+    vst1q_f32(delta_, d);
+#else
+    float t[4], m[4], d[4];
+    for (size_t l = 0; l < 4; ++l) {
+      t[l] = target_[l];
+      m[l] = mult_[l];
+      d[l] = delta_[l];
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+      for (size_t l = 0; l < 4; ++l) {
+        d[l] *= m[l];
+        out[4 * i + l] = t[l] + d[l];
+      }
+    }
+    for (size_t l = 0; l < 4; ++l) delta_[l] = d[l];
+#endif
+  }
+
+  AdsrParams params_;
+  AdsrStage stage_[4];
+  uint32_t remaining_[4];
+  float target_[4] __attribute__((aligned(16)));
+  float delta_[4] __attribute__((aligned(16)));
+  float mult_[4] __attribute__((aligned(16)));
+};
+
+}  // namespace dsp
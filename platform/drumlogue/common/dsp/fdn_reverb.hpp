@@ -0,0 +1,320 @@
+#pragma once
+/**
+ * @file fdn_reverb.hpp
+ * @brief Feedback delay network reverb
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "attributes.h"
+#include "biquad.hpp"
+#include "delayline.hpp"
+
+namespace dsp {
+
+/**
+ * Stereo feedback delay network reverb.
+ *
+ * Lines share one MultiDelayLine so that the feedback vector is written with
+ * aligned vector stores, taps are read at per-line fractional positions. Each
+ * line has a one-pole damping filter and a decay gain derived from the
+ * reverb time and its length, lines are mixed with a normalized Hadamard
+ * matrix. Tap positions are slowly modulated to break up modal ringing.
+ *
+ * All memory is provided by the caller at init(), kMemorySize floats, no
+ * allocation takes place afterwards. Parameter changes are applied at block
+ * rate, delay positions ramp linearly across each block.
+ *
+ * @tparam Lines Number of delay lines, 8 or 16.
+ */
+template <size_t Lines>
+class FdnReverb {
+ public:
+  static_assert(Lines == 8 || Lines == 16, "Only 8 and 16 line networks are supported.");
+
+  /** Frames per delay line, fits the longest line at maximum size plus modulation */
+  static constexpr size_t kLineSize = 8192;
+  /** Required memory in floats */
+  static constexpr size_t kMemorySize = kLineSize * MultiDelayLine<Lines>::kStride;
+
+  FdnReverb(void)
+      : fs_(48000.f),
+        time_(2.f),
+        damping_(0.5f),
+        size_(1.f),
+        size_z_(1.f),
+        mod_depth_(0.3f),
+        dry_(1.f),
+        wet_(0.3f) {}
+
+  /**
+   * Attach the backing memory and reset the network.
+   *
+   * @param ram kMemorySize floats, 16 byte aligned
+   * @param samplerate Sampling rate in Hz
+   */
+  inline void init(float *ram, float samplerate) {
+    fs_ = samplerate;
+    lines_.setMemory(ram, kLineSize);
+    input_filter_.setCoeffs(0, lowCut());
+    input_filter_.setCoeffs(1, highCut());
+    for (size_t i = 0; i < Lines; ++i) {
+      // Note: alternate signs decorrelate the line inputs and the two output channels
+      in_gain_[i] = (i & 1) ? -1.f : 1.f;
+      out_l_[i] = (i & 2) ? -1.f : 1.f;
+      out_r_[i] = ((i ^ (i >> 2)) & 1) ? -1.f : 1.f;
+      mod_rate_[i] = (0.31f + 0.57f * i / Lines) / fs_;
+    }
+    reset();
+  }
+
+  /**
+   * Clear the delay lines and filter states.
+   */
+  inline void reset(void) {
+    lines_.clear();
+    input_filter_.flush();
+    size_z_ = size_;
+    for (size_t i = 0; i < Lines; ++i) {
+      lp_[i] = 0.f;
+      mod_phase_[i] = static_cast<float>(i) / Lines;
+    }
+    updatePositions(0);
+    for (size_t i = 0; i < Lines; ++i) pos_[i] = pos_end_[i];
+  }
+
+  /**
+   * @param seconds Time to decay by 60 dB
+   */
+  inline void setTime(float seconds) { time_ = (seconds < 0.05f) ? 0.05f : seconds; }
+
+  /**
+   * @param damping High frequency damping in [0, 1]
+   */
+  inline void setDamping(float damping) { damping_ = damping; }
+
+  /**
+   * @param size Scale of the line lengths in [0.25, 1]
+   */
+  inline void setSize(float size) { size_ = (size < 0.25f) ? 0.25f : (size > 1.f) ? 1.f : size; }
+
+  /**
+   * @param depth Tap modulation depth in [0, 1]
+   */
+  inline void setModulation(float depth) { mod_depth_ = depth; }
+
+  /**
+   * @param dry Gain of the input signal
+   * @param wet Gain of the reverb signal
+   */
+  inline void setLevels(float dry, float wet) {
+    dry_ = dry;
+    wet_ = wet;
+  }
+
+  /**
+   * Process an interleaved stereo buffer.
+   *
+   * @param in Interleaved stereo input
+   * @param out Interleaved stereo output, may be the same as in
+   * @param frames Number of frames
+   */
+  fast_inline void process(const float *in, float *out, size_t frames) {
+    if (frames == 0) return;
+    updateBlock(frames);
+
+    const float dry = dry_;
+    const float wet = wet_ * kOutputScale;
+    float tap[Lines] __attribute__((aligned(16)));
+    float fb[Lines] __attribute__((aligned(16)));
+
+    for (size_t n = 0; n < frames; ++n, in += 2, out += 2) {
+      const float xl = in[0];
+      const float xr = in[1];
+      const float x = input_filter_.process(0.5f * (xl + xr));
+
+      for (size_t i = 0; i < Lines; ++i) pos_[i] += pos_inc_[i];
+      lines_.readTapsFrac(pos_, tap);
+
+      float yl, yr;
+      feedback(tap, fb, yl, yr);
+      hadamard(fb);
+      for (size_t i = 0; i < Lines; ++i) fb[i] += in_gain_[i] * x;
+      lines_.write(fb);
+
+      out[0] = dry * xl + wet * yl;
+      out[1] = dry * xr + wet * yr;
+    }
+  }
+
+ private:
+  static constexpr float kOutputScale = 1.f / Lines;
+  static constexpr float kMaxModDepth = 16.f;
+
+  /**
+   * Line lengths in seconds at full size, 8 line networks use every other length.
+   */
+  static fast_inline float baseLength(size_t line) {
+    static const float kLengths[16] = {0.0297f, 0.0331f, 0.0371f, 0.0411f, 0.0437f, 0.0473f, 0.0531f, 0.0563f,
+                                       0.0593f, 0.0631f, 0.0677f, 0.0709f, 0.0731f, 0.0787f, 0.0829f, 0.0863f};
+    return kLengths[line * (16 / Lines)];
+  }
+
+  inline BiQuad::Coeffs lowCut(void) const {
+    BiQuad::Coeffs c;
+    c.setSOHP(std::tan(M_PI * 80.f / fs_), M_SQRT2);
+    return c;
+  }
+
+  inline BiQuad::Coeffs highCut(void) const {
+    BiQuad::Coeffs c;
+    c.setSOLP(std::tan(M_PI * 9000.f / fs_), M_SQRT2);
+    return c;
+  }
+
+  /**
+   * Tap positions at the end of the next block.
+   */
+  inline void updatePositions(size_t frames) {
+    const float depth = mod_depth_ * kMaxModDepth;
+    for (size_t i = 0; i < Lines; ++i) {
+      mod_phase_[i] += mod_rate_[i] * frames;
+      mod_phase_[i] -= static_cast<uint32_t>(mod_phase_[i]);
+      const float mod = depth * (1.f + std::sin(2.f * static_cast<float>(M_PI) * mod_phase_[i]));
+      pos_end_[i] = baseLength(i) * size_z_ * fs_ + mod;
+    }
+  }
+
+  /**
+   * Block rate update of line gains and position ramps, keeps divisions and transcendentals out of the sample loop.
+   */
+  inline void updateBlock(size_t frames) {
+    // Note: size changes are smoothed over blocks, the position ramps turn them into short pitch glides
+    size_z_ += 0.1f * (size_ - size_z_);
+    updatePositions(frames);
+
+    const float r = 1.f / frames;
+    const float decay = -3.f / (time_ * fs_);
+    const float damp = 0.05f + 0.9f * damping_;
+    for (size_t i = 0; i < Lines; ++i) {
+      pos_inc_[i] = (pos_end_[i] - pos_[i]) * r;
+      // Note: 60 dB attenuation after time_ seconds, per pass through a line of this length
+      gain_[i] = std::pow(10.f, decay * pos_end_[i]);
+      damp_[i] = damp;
+    }
+  }
+
+  /**
+   * Damping and decay of the taps into the feedback vector, and stereo output taps.
+   */
+  fast_inline void feedback(const float *tap, float *fb, float &yl, float &yr) {
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    float32x4_t accl = vdupq_n_f32(0.f);
+    float32x4_t accr = vdupq_n_f32(0.f);
+    for (size_t i = 0; i < Lines; i += 4) {
+      const float32x4_t t = vld1q_f32(&tap[i]);
+      const float32x4_t lp = vmlaq_f32(t, vsubq_f32(vld1q_f32(&lp_[i]), t), vld1q_f32(&damp_[i]));
+      vst1q_f32(&lp_[i], lp);
+      vst1q_f32(&fb[i], vmulq_f32(lp, vld1q_f32(&gain_[i])));
+      accl = vmlaq_f32(accl, t, vld1q_f32(&out_l_[i]));
+      accr = vmlaq_f32(accr, t, vld1q_f32(&out_r_[i]));
+    }
+    const float32x2_t l = vadd_f32(vget_low_f32(accl), vget_high_f32(accl));
+    const float32x2_t r = vadd_f32(vget_low_f32(accr), vget_high_f32(accr));
+    yl = vget_lane_f32(l, 0) + vget_lane_f32(l, 1);
+    yr = vget_lane_f32(r, 0) + vget_lane_f32(r, 1);
+#else
+    yl = yr = 0.f;
+    for (size_t i = 0; i < Lines; ++i) {
+      const float t = tap[i];
+      lp_[i] = t + damp_[i] * (lp_[i] - t);
+      fb[i] = lp_[i] * gain_[i];
+      yl += out_l_[i] * t;
+      yr += out_r_[i] * t;
+    }
+#endif
+  }
+
+  /**
+   * In-place normalized Hadamard transform of the feedback vector.
+   */
+  static fast_inline void hadamard(float *x) {
+    const float scale = (Lines == 8) ? 0.35355339f : 0.25f;  // 1/sqrt(Lines)
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    static const float kSign[2] = {1.f, -1.f};
+    const float32x2_t sign = vld1_f32(kSign);
+    float32x4_t v[Lines / 4];
+    for (size_t k = 0; k < Lines / 4; ++k) {
+      // Note: 4-point transform within a vector, rows in natural order up to a permutation
+      const float32x4_t a = vld1q_f32(&x[4 * k]);
+      const float32x2_t s = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+      const float32x2_t d = vsub_f32(vget_low_f32(a), vget_high_f32(a));
+      v[k] = vcombine_f32(vmla_f32(vrev64_f32(s), s, sign), vmla_f32(vrev64_f32(d), d, sign));
+    }
+    for (size_t h = 1; h < Lines / 4; h <<= 1) {
+      for (size_t k = 0; k < Lines / 4; k += 2 * h) {
+        for (size_t j = k; j < k + h; ++j) {
+          const float32x4_t a = v[j];
+          v[j] = vaddq_f32(a, v[j + h]);
+          v[j + h] = vsubq_f32(a, v[j + h]);
+        }
+      }
+    }
+    for (size_t k = 0; k < Lines / 4; ++k) vst1q_f32(&x[4 * k], vmulq_n_f32(v[k], scale));
+#else
+    for (size_t k = 0; k < Lines; k += 4) {
+      const float s0 = x[k] + x[k + 2], s1 = x[k + 1] + x[k + 3];
+      const float d0 = x[k] - x[k + 2], d1 = x[k + 1] - x[k + 3];
+      x[k] = s1 + s0;
+      x[k + 1] = s0 - s1;
+      x[k + 2] = d1 + d0;
+      x[k + 3] = d0 - d1;
+    }
+    for (size_t h = 4; h < Lines; h <<= 1) {
+      for (size_t k = 0; k < Lines; k += 2 * h) {
+        for (size_t j = k; j < k + h; ++j) {
+          const float a = x[j];
+          x[j] = a + x[j + h];
+          x[j + h] = a - x[j + h];
+        }
+      }
+    }
+    for (size_t i = 0; i < Lines; ++i) x[i] *= scale;
+#endif
+  }
+
+  MultiDelayLine<Lines> lines_;
+  BiQuadCascade<2> input_filter_;
+
+  float pos_[Lines] __attribute__((aligned(16)));
+  float pos_end_[Lines] __attribute__((aligned(16)));
+  float pos_inc_[Lines] __attribute__((aligned(16)));
+  float gain_[Lines] __attribute__((aligned(16)));
+  float damp_[Lines] __attribute__((aligned(16)));
+  float lp_[Lines] __attribute__((aligned(16)));
+  float in_gain_[Lines] __attribute__((aligned(16)));
+  float out_l_[Lines] __attribute__((aligned(16)));
+  float out_r_[Lines] __attribute__((aligned(16)));
+  float mod_phase_[Lines];
+  float mod_rate_[Lines];
+
+  float fs_;
+  float time_;
+  float damping_;
+  float size_;
+  float size_z_;
+  float mod_depth_;
+  float dry_;
+  float wet_;
+};
+
+}  // namespace dsp
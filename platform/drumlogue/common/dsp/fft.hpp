@@ -0,0 +1,425 @@
+#pragma once
+/**
+ * @file fft.hpp
+ * @brief Complex and real fast Fourier transforms
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "attributes.h"
+
+namespace dsp {
+
+/**
+ * Complex FFT on split real/imaginary arrays, Stockham radix-4 with a final
+ * radix-2 stage for odd powers of two. No bit reversal pass is needed, each
+ * stage reads one buffer and writes the other.
+ *
+ * The inverse transform is the forward transform with real and imaginary
+ * arrays swapped, unscaled.
+ *
+ * @tparam N Transform size, power of two, at least 16
+ */
+template <size_t N>
+class ComplexFft {
+ public:
+  static_assert(N >= 16 && (N & (N - 1)) == 0, "Size must be a power of two, at least 16.");
+
+  ComplexFft(void) {
+    for (size_t k = 0; k < N; ++k) {
+      const double a = -2.0 * M_PI * k / N;
+      w_re_[k] = static_cast<float>(std::cos(a));
+      w_im_[k] = static_cast<float>(std::sin(a));
+    }
+    // Note: first stage twiddles stored contiguously per butterfly leg for vector loads
+    for (size_t p = 0; p < N / 4; ++p) {
+      for (size_t l = 0; l < 3; ++l) {
+        t_re_[l][p] = w_re_[(l + 1) * p];
+        t_im_[l][p] = w_im_[(l + 1) * p];
+      }
+    }
+  }
+
+  /**
+   * In-place forward transform.
+   *
+   * @param re Real parts, N floats, 16 byte aligned
+   * @param im Imaginary parts, N floats, 16 byte aligned
+   * @param work_re Scratch, N floats, 16 byte aligned
+   * @param work_im Scratch, N floats, 16 byte aligned
+   */
+  fast_inline void forward(float *re, float *im, float *work_re, float *work_im) const {
+    float *x_re = re, *x_im = im;
+    float *y_re = work_re, *y_im = work_im;
+
+    size_t n = N;
+    size_t s = 1;
+    for (; n >= 4; n >>= 2, s <<= 2) {
+      if (s == 1)
+        firstStage(x_re, x_im, y_re, y_im);
+      else
+        radix4Stage(n, s, x_re, x_im, y_re, y_im);
+      swap(x_re, y_re);
+      swap(x_im, y_im);
+    }
+    if (n == 2) {
+      radix2Stage(s, x_re, x_im, y_re, y_im);
+      swap(x_re, y_re);
+      swap(x_im, y_im);
+    }
+
+    if (x_re != re) {
+      std::memcpy(re, x_re, N * sizeof(float));
+      std::memcpy(im, x_im, N * sizeof(float));
+    }
+  }
+
+  /**
+   * In-place inverse transform, scaled by N.
+   */
+  fast_inline void inverse(float *re, float *im, float *work_re, float *work_im) const {
+    forward(im, re, work_im, work_re);
+  }
+
+ private:
+  static fast_inline void swap(float *&a, float *&b) {
+    float *t = a;
+    a = b;
+    b = t;
+  }
+
+  /**
+   * First stage, s = 1: butterflies vectorized across p, outputs interleaved by four.
+   */
+  fast_inline void firstStage(const float *x_re, const float *x_im, float *y_re, float *y_im) const {
+    constexpr size_t m = N / 4;
+    size_t p = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; p < m; p += 4) {
+      const float32x4_t ar = vld1q_f32(&x_re[p]), ai = vld1q_f32(&x_im[p]);
+      const float32x4_t br = vld1q_f32(&x_re[p + m]), bi = vld1q_f32(&x_im[p + m]);
+      const float32x4_t cr = vld1q_f32(&x_re[p + 2 * m]), ci = vld1q_f32(&x_im[p + 2 * m]);
+      const float32x4_t dr = vld1q_f32(&x_re[p + 3 * m]), di = vld1q_f32(&x_im[p + 3 * m]);
+      float32x4x4_t or_, oi;
+      butterfly4(ar, ai, br, bi, cr, ci, dr, di,                                          //
+                 vld1q_f32(&t_re_[0][p]), vld1q_f32(&t_im_[0][p]),                        //
+                 vld1q_f32(&t_re_[1][p]), vld1q_f32(&t_im_[1][p]),                        //
+                 vld1q_f32(&t_re_[2][p]), vld1q_f32(&t_im_[2][p]), or_.val, oi.val);
+      vst4q_f32(&y_re[4 * p], or_);
+      vst4q_f32(&y_im[4 * p], oi);
+    }
+#endif
+    for (; p < m; ++p) {
+      float o_re[4], o_im[4];
+      butterfly4(x_re[p], x_im[p], x_re[p + m], x_im[p + m], x_re[p + 2 * m], x_im[p + 2 * m], x_re[p + 3 * m],
+                 x_im[p + 3 * m], t_re_[0][p], t_im_[0][p], t_re_[1][p], t_im_[1][p], t_re_[2][p], t_im_[2][p], o_re,
+                 o_im);
+      for (size_t k = 0; k < 4; ++k) {
+        y_re[4 * p + k] = o_re[k];
+        y_im[4 * p + k] = o_im[k];
+      }
+    }
+  }
+
+  /**
+   * Radix-4 stage of length n at stride s >= 4: butterflies vectorized across q with shared twiddles.
+   */
+  fast_inline void radix4Stage(size_t n, size_t s, const float *x_re, const float *x_im, float *y_re,
+                               float *y_im) const {
+    const size_t m = n / 4;
+    for (size_t p = 0; p < m; ++p) {
+      const float w1r = w_re_[p * s], w1i = w_im_[p * s];
+      const float w2r = w_re_[2 * p * s], w2i = w_im_[2 * p * s];
+      const float w3r = w_re_[3 * p * s], w3i = w_im_[3 * p * s];
+      const float *a_re = x_re + s * p, *a_im = x_im + s * p;
+      float *o_re = y_re + s * 4 * p, *o_im = y_im + s * 4 * p;
+      const size_t sm = s * m;
+      size_t q = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+      for (; q < s; q += 4) {
+        float32x4_t r[4], i[4];
+        butterfly4(vld1q_f32(&a_re[q]), vld1q_f32(&a_im[q]), vld1q_f32(&a_re[q + sm]), vld1q_f32(&a_im[q + sm]),
+                   vld1q_f32(&a_re[q + 2 * sm]), vld1q_f32(&a_im[q + 2 * sm]), vld1q_f32(&a_re[q + 3 * sm]),
+                   vld1q_f32(&a_im[q + 3 * sm]), vdupq_n_f32(w1r), vdupq_n_f32(w1i), vdupq_n_f32(w2r),
+                   vdupq_n_f32(w2i), vdupq_n_f32(w3r), vdupq_n_f32(w3i), r, i);
+        for (size_t k = 0; k < 4; ++k) {
+          vst1q_f32(&o_re[q + k * s], r[k]);
+          vst1q_f32(&o_im[q + k * s], i[k]);
+        }
+      }
+#endif
+      for (; q < s; ++q) {
+        float r[4], i[4];
+        butterfly4(a_re[q], a_im[q], a_re[q + sm], a_im[q + sm], a_re[q + 2 * sm], a_im[q + 2 * sm], a_re[q + 3 * sm],
+                   a_im[q + 3 * sm], w1r, w1i, w2r, w2i, w3r, w3i, r, i);
+        for (size_t k = 0; k < 4; ++k) {
+          o_re[q + k * s] = r[k];
+          o_im[q + k * s] = i[k];
+        }
+      }
+    }
+  }
+
+  /**
+   * Final radix-2 stage for odd powers of two, unit twiddles.
+   */
+  static fast_inline void radix2Stage(size_t s, const float *x_re, const float *x_im, float *y_re, float *y_im) {
+    size_t q = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; q < s; q += 4) {
+      const float32x4_t ar = vld1q_f32(&x_re[q]), ai = vld1q_f32(&x_im[q]);
+      const float32x4_t br = vld1q_f32(&x_re[q + s]), bi = vld1q_f32(&x_im[q + s]);
+      vst1q_f32(&y_re[q], vaddq_f32(ar, br));
+      vst1q_f32(&y_im[q], vaddq_f32(ai, bi));
+      vst1q_f32(&y_re[q + s], vsubq_f32(ar, br));
+      vst1q_f32(&y_im[q + s], vsubq_f32(ai, bi));
+    }
+#endif
+    for (; q < s; ++q) {
+      const float ar = x_re[q], ai = x_im[q], br = x_re[q + s], bi = x_im[q + s];
+      y_re[q] = ar + br;
+      y_im[q] = ai + bi;
+      y_re[q + s] = ar - br;
+      y_im[q + s] = ai - bi;
+    }
+  }
+
+  /**
+   * Radix-4 decimation in frequency butterfly, outputs 1 to 3 multiplied by twiddles w1 to w3.
+   */
+  template <typename T>
+  static fast_inline void butterfly4(T ar, T ai, T br, T bi, T cr, T ci, T dr, T di, T w1r, T w1i, T w2r, T w2i,
+                                     T w3r, T w3i, T *o_re, T *o_im) {
+    const T apc_r = ar + cr, apc_i = ai + ci;
+    const T amc_r = ar - cr, amc_i = ai - ci;
+    const T bpd_r = br + dr, bpd_i = bi + di;
+    // Note: -i * (b - d)
+    const T jbmd_r = bi - di, jbmd_i = dr - br;
+    const T x1r = amc_r + jbmd_r, x1i = amc_i + jbmd_i;
+    const T x2r = apc_r - bpd_r, x2i = apc_i - bpd_i;
+    const T x3r = amc_r - jbmd_r, x3i = amc_i - jbmd_i;
+    o_re[0] = apc_r + bpd_r;
+    o_im[0] = apc_i + bpd_i;
+    o_re[1] = x1r * w1r - x1i * w1i;
+    o_im[1] = x1r * w1i + x1i * w1r;
+    o_re[2] = x2r * w2r - x2i * w2i;
+    o_im[2] = x2r * w2i + x2i * w2r;
+    o_re[3] = x3r * w3r - x3i * w3i;
+    o_im[3] = x3r * w3i + x3i * w3r;
+  }
+
+  float w_re_[N] __attribute__((aligned(16)));
+  float w_im_[N] __attribute__((aligned(16)));
+  float t_re_[3][N / 4] __attribute__((aligned(16)));
+  float t_im_[3][N / 4] __attribute__((aligned(16)));
+};
+
+/**
+ * Real FFT of size N, computed with a complex FFT of size N/2 on the even and
+ * odd samples packed as real and imaginary parts, followed by a split pass.
+ *
+ * Spectra use a packed split layout of N floats: element k holds Re X[k]
+ * for k in [0, N/2), element N/2 holds Re X[N/2] and element N/2 + k holds
+ * Im X[k] for k in [1, N/2). Im X[0] and Im X[N/2] are always zero and are
+ * not stored.
+ *
+ * Transforms can run in place or out of place. The inverse transform is
+ * scaled by N.
+ *
+ * @tparam N Transform size, power of two, at least 32, typically 64 to 4096
+ */
+template <size_t N>
+class RealFft {
+ public:
+  static_assert(N >= 32 && (N & (N - 1)) == 0, "Size must be a power of two, at least 32.");
+
+  /** Number of complex bins in the packed spectrum, excluding the Nyquist bin */
+  static constexpr size_t kHalf = N / 2;
+
+  RealFft(void) {
+    for (size_t k = 0; k < kHalf; ++k) {
+      const double a = -2.0 * M_PI * k / N;
+      w_re_[k] = static_cast<float>(std::cos(a));
+      w_im_[k] = static_cast<float>(std::sin(a));
+    }
+  }
+
+  /**
+   * Forward transform.
+   *
+   * @param in N real samples
+   * @param out Packed spectrum, N floats, may be the same as in
+   */
+  fast_inline void forward(const float *in, float *out) {
+    // Note: even samples into the real part, odd samples into the imaginary part
+    size_t n = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; n < kHalf; n += 4) {
+      const float32x4x2_t v = vld2q_f32(&in[2 * n]);
+      vst1q_f32(&z_re_[n], v.val[0]);
+      vst1q_f32(&z_im_[n], v.val[1]);
+    }
+#endif
+    for (; n < kHalf; ++n) {
+      z_re_[n] = in[2 * n];
+      z_im_[n] = in[2 * n + 1];
+    }
+
+    fft_.forward(z_re_, z_im_, work_re_, work_im_);
+
+    // Note: X[k] = E[k] + W^k O[k], with E[k] = (Z[k] + Z*[N/2-k]) / 2 and O[k] = -i (Z[k] - Z*[N/2-k]) / 2
+    const float z0_re = z_re_[0], z0_im = z_im_[0];
+    size_t k = 1;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; k < 4; ++k) forwardSplit(k, out);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    for (; k < kHalf; k += 4) {
+      const float32x4_t ar = vld1q_f32(&z_re_[k]), ai = vld1q_f32(&z_im_[k]);
+      const float32x4_t br = reverse(vld1q_f32(&z_re_[kHalf - k - 3]));
+      const float32x4_t bi = reverse(vld1q_f32(&z_im_[kHalf - k - 3]));
+      const float32x4_t er = vmulq_f32(vaddq_f32(ar, br), half), ei = vmulq_f32(vsubq_f32(ai, bi), half);
+      const float32x4_t or_ = vmulq_f32(vaddq_f32(ai, bi), half), oi = vmulq_f32(vsubq_f32(br, ar), half);
+      const float32x4_t wr = vld1q_f32(&w_re_[k]), wi = vld1q_f32(&w_im_[k]);
+      vst1q_f32(&out[k], vmlsq_f32(vmlaq_f32(er, or_, wr), oi, wi));
+      vst1q_f32(&out[kHalf + k], vmlaq_f32(vmlaq_f32(ei, oi, wr), or_, wi));
+    }
+#endif
+    for (; k < kHalf; ++k) forwardSplit(k, out);
+    out[0] = z0_re + z0_im;
+    out[kHalf] = z0_re - z0_im;
+  }
+
+  /**
+   * In-place forward transform.
+   *
+   * @param x N real samples, replaced by the packed spectrum
+   */
+  fast_inline void forward(float *x) { forward(x, x); }
+
+  /**
+   * Inverse transform, scaled by N.
+   *
+   * @param in Packed spectrum, N floats
+   * @param out N real samples, may be the same as in
+   */
+  fast_inline void inverse(const float *in, float *out) {
+    // Note: Z[k] = E[k] + i W^-k O[k], with E[k] = X[k] + X*[N/2-k] and O[k] = X[k] - X*[N/2-k]
+    size_t k = 1;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; k < 4; ++k) inverseSplit(k, in);
+    for (; k < kHalf; k += 4) {
+      const float32x4_t ar = vld1q_f32(&in[k]), ai = vld1q_f32(&in[kHalf + k]);
+      const float32x4_t br = reverse(vld1q_f32(&in[kHalf - k - 3]));
+      const float32x4_t bi = reverse(vld1q_f32(&in[N - k - 3]));
+      const float32x4_t er = vaddq_f32(ar, br), ei = vsubq_f32(ai, bi);
+      const float32x4_t dr = vsubq_f32(ar, br), di = vaddq_f32(ai, bi);
+      const float32x4_t wr = vld1q_f32(&w_re_[k]), wi = vld1q_f32(&w_im_[k]);
+      const float32x4_t or_ = vmlaq_f32(vmulq_f32(dr, wr), di, wi), oi = vmlsq_f32(vmulq_f32(di, wr), dr, wi);
+      vst1q_f32(&z_re_[k], vsubq_f32(er, oi));
+      vst1q_f32(&z_im_[k], vaddq_f32(ei, or_));
+    }
+#endif
+    for (; k < kHalf; ++k) inverseSplit(k, in);
+    z_re_[0] = in[0] + in[kHalf];
+    z_im_[0] = in[0] - in[kHalf];
+
+    fft_.inverse(z_re_, z_im_, work_re_, work_im_);
+
+    size_t n = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; n < kHalf; n += 4) {
+      float32x4x2_t v;
+      v.val[0] = vld1q_f32(&z_re_[n]);
+      v.val[1] = vld1q_f32(&z_im_[n]);
+      vst2q_f32(&out[2 * n], v);
+    }
+#endif
+    for (; n < kHalf; ++n) {
+      out[2 * n] = z_re_[n];
+      out[2 * n + 1] = z_im_[n];
+    }
+  }
+
+  /**
+   * In-place inverse transform, scaled by N.
+   *
+   * @param x Packed spectrum, replaced by N real samples
+   */
+  fast_inline void inverse(float *x) { inverse(x, x); }
+
+  /**
+   * Multiply two packed spectra and add the product to a third, e.g. for fast convolution.
+   *
+   * @param acc Accumulated packed spectrum, N floats
+   * @param a Packed spectrum, N floats
+   * @param b Packed spectrum, N floats
+   */
+  static fast_inline void multiplyAccumulate(float *acc, const float *a, const float *b) {
+    // Note: DC and Nyquist bins are real and share the first complex slot
+    const float dc = acc[0] + a[0] * b[0];
+    const float nyquist = acc[kHalf] + a[kHalf] * b[kHalf];
+    size_t k = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; k < kHalf; k += 4) {
+      const float32x4_t ar = vld1q_f32(&a[k]), ai = vld1q_f32(&a[kHalf + k]);
+      const float32x4_t br = vld1q_f32(&b[k]), bi = vld1q_f32(&b[kHalf + k]);
+      vst1q_f32(&acc[k], vmlsq_f32(vmlaq_f32(vld1q_f32(&acc[k]), ar, br), ai, bi));
+      vst1q_f32(&acc[kHalf + k], vmlaq_f32(vmlaq_f32(vld1q_f32(&acc[kHalf + k]), ar, bi), ai, br));
+    }
+#endif
+    for (; k < kHalf; ++k) {
+      const float ar = a[k], ai = a[kHalf + k], br = b[k], bi = b[kHalf + k];
+      acc[k] += ar * br - ai * bi;
+      acc[kHalf + k] += ar * bi + ai * br;
+    }
+    acc[0] = dc;
+    acc[kHalf] = nyquist;
+  }
+
+ private:
+  fast_inline void forwardSplit(size_t k, float *out) const {
+    const float ar = z_re_[k], ai = z_im_[k];
+    const float br = z_re_[kHalf - k], bi = z_im_[kHalf - k];
+    const float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);
+    const float or_ = 0.5f * (ai + bi), oi = 0.5f * (br - ar);
+    out[k] = er + or_ * w_re_[k] - oi * w_im_[k];
+    out[kHalf + k] = ei + oi * w_re_[k] + or_ * w_im_[k];
+  }
+
+  fast_inline void inverseSplit(size_t k, const float *in) {
+    const float ar = in[k], ai = in[kHalf + k];
+    const float br = in[kHalf - k], bi = in[N - k];
+    const float er = ar + br, ei = ai - bi;
+    const float dr = ar - br, di = ai + bi;
+    const float or_ = dr * w_re_[k] + di * w_im_[k], oi = di * w_re_[k] - dr * w_im_[k];
+    z_re_[k] = er - oi;
+    z_im_[k] = ei + or_;
+  }
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+  static fast_inline float32x4_t reverse(float32x4_t v) {
+    v = vrev64q_f32(v);
+    return vcombine_f32(vget_high_f32(v), vget_low_f32(v));
+  }
+#endif
+
+  ComplexFft<kHalf> fft_;
+
+  float w_re_[kHalf] __attribute__((aligned(16)));
+  float w_im_[kHalf] __attribute__((aligned(16)));
+  float z_re_[kHalf] __attribute__((aligned(16)));
+  float z_im_[kHalf] __attribute__((aligned(16)));
+  float work_re_[kHalf] __attribute__((aligned(16)));
+  float work_im_[kHalf] __attribute__((aligned(16)));
+};
+
+}  // namespace dsp
@@ -0,0 +1,610 @@
+#pragma once
+/**
+ * @file polyblep.hpp
+ * @brief Bandlimited oscillators using tabulated BLEP and BLAMP corrections
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "attributes.h"
+#include "window.hpp"
+
+namespace dsp {
+
+/**
+ * Oscillator waveforms, output in [-1, 1].
+ */
+enum PolyBlepShape {
+  k_polyblep_saw = 0U,
+  k_polyblep_pulse,     // square at a pulse width of 0.5
+  k_polyblep_triangle,
+  k_num_polyblep_shapes
+};
+
+/**
+ * Band-limited step (BLEP) and ramp (BLAMP) residuals.
+ *
+ * Differences between the integrals of a Kaiser windowed sinc and the ideal
+ * step and ramp, tabulated over kTaps samples with the kernel itself, the
+ * derivative of the step, for cubic Hermite interpolation between table
+ * points. The cutoff is at 0.38 of the sample rate so that the stop band
+ * starts below Nyquist: harmonics fold back attenuated by about 85 dB while
+ * the ones up to 15 kHz at 48 kHz are kept within 0.3 dB.
+ */
+class BlepResidual {
+ public:
+  /** Samples corrected around each discontinuity, the output is delayed by kDelay */
+  static constexpr size_t kTaps = 24;
+  static constexpr size_t kDelay = kTaps / 2;
+
+  /** Size of the ring of pending output samples, a power of 2 of at least kTaps */
+  static constexpr size_t kRingSize = 32;
+
+  /**
+   * Add the corrections of a discontinuity to a ring of pending output samples.
+   *
+   * @param h Step in value
+   * @param s Step in slope, per sample
+   * @param t Position in samples before the current sample, in [0, 1]
+   * @param ring Ring of kRingSize samples
+   * @param stride Distance between ring samples, e.g. 4 for one lane of frame-major rings
+   * @param pos Ring index of the current sample
+   */
+  static fast_inline void add(float h, float s, float t, float *ring, size_t stride, size_t pos) {
+    const Table &table = getTable();
+    const float p = t * kPhases;
+    size_t k = static_cast<size_t>(p);
+    if (k >= kPhases) k = kPhases - 1;
+    const float f = p - k;
+    const float *step = table.step + k;
+    const float *ramp = table.ramp + k;
+    const float *kernel = table.kernel + k;
+    size_t r = pos - kDelay;
+
+    // Note: Hermite basis, the derivative terms scaled to the table spacing
+    const float f2 = f * f;
+    const float b1 = 3.f * f2 - 2.f * f2 * f;
+    const float b0 = 1.f - b1;
+    const float d0 = (f2 * f - 2.f * f2 + f) * (1.f / kPhases);
+    const float d1 = (f2 * f - f2) * (1.f / kPhases);
+
+    // Note: smooth integrals, then minus the ideal step and ramp from the discontinuity on
+    for (size_t j = 0; j < kTaps; ++j, step += kPhases, ramp += kPhases, kernel += kPhases, ++r) {
+      float c = h * (b0 * step[0] + b1 * step[1] + d0 * kernel[0] + d1 * kernel[1]) +
+                s * (b0 * ramp[0] + b1 * ramp[1] + d0 * step[0] + d1 * step[1]);
+      if (j >= kDelay) c -= h + s * ((j - kDelay) + t);
+      ring[(r & (kRingSize - 1)) * stride] += c;
+    }
+  }
+
+ private:
+  static constexpr size_t kPhases = 16;
+  static constexpr size_t kSize = kTaps * kPhases + 1;
+
+  struct Table {
+    Table(void) {
+      const float cutoff = 0.38f;
+      const float beta = 8.f;
+      const size_t sub = 16;
+      const float dx = 1.f / (kPhases * sub);
+      const auto windowed_sinc = [&](float x) {
+        const float sinc = (fabsf(x) < 1e-6f) ? 2.f * cutoff : sinf(2.f * M_PI * cutoff * x) / (M_PI * x);
+        return sinc * kaiser_window(x / kDelay, beta);
+      };
+
+      // Note: trapezoidal integration, sub steps per table point
+      double i = 0.0;
+      double r = 0.0;
+      float k0 = windowed_sinc(-static_cast<float>(kDelay));
+      step[0] = ramp[0] = 0.f;
+      kernel[0] = k0;
+      for (size_t n = 1; n < kSize; ++n) {
+        for (size_t m = 1; m <= sub; ++m) {
+          const float k1 = windowed_sinc(((n - 1) * sub + m) * dx - kDelay);
+          const double i1 = i + 0.5 * (k0 + k1) * dx;
+          r += 0.5 * (i + i1) * dx;
+          i = i1;
+          k0 = k1;
+        }
+        step[n] = i;
+        ramp[n] = r;
+        kernel[n] = k0;
+      }
+      // Note: unity step
+      const float scale = 1.f / step[kSize - 1];
+      for (size_t n = 0; n < kSize; ++n) {
+        step[n] *= scale;
+        ramp[n] *= scale;
+        kernel[n] *= scale;
+      }
+    }
+    float step[kSize];
+    float ramp[kSize];
+    float kernel[kSize];
+  };
+
+  static inline const Table &getTable(void) {
+    static const Table table;
+    return table;
+  }
+};
+
+/**
+ * Oscillator with bandlimited step (BLEP) and ramp (BLAMP) corrections, with
+ * optional hard sync to an internal master phase.
+ *
+ * Each discontinuity in value (saw and pulse edges) or slope (triangle
+ * corners), including the ones caused by sync resets, is located to a
+ * fraction of a sample and corrected with BlepResidual over the
+ * BlepResidual::kTaps samples around it. The output is therefore delayed by
+ * BlepResidual::kDelay samples.
+ *
+ * Frequencies are normalized, in cycles per sample, below 0.5.
+ */
+class PolyBlepOsc {
+ public:
+  PolyBlepOsc(void) : shape_(k_polyblep_saw), w_(0.f), sync_w_(0.f), width_(0.5f) { reset(); }
+
+  /**
+   * Restart the phases and clear the correction state.
+   */
+  inline void reset(void) {
+    phase_ = 0.f;
+    master_ = 0.f;
+    for (size_t i = 0; i < kRingSize; ++i) ring_[i] = 0.f;
+    pos_ = 0;
+    primed_ = false;
+  }
+
+  inline void setShape(PolyBlepShape shape) { shape_ = shape; }
+
+  /**
+   * @param w Frequency in cycles per sample, clipped to [0, 0.49]
+   */
+  inline void setFrequency(float w) { w_ = clip(w); }
+
+  /**
+   * Hard sync: the phase restarts at every cycle of a master oscillator.
+   *
+   * @param w Master frequency in cycles per sample, clipped to [0, 0.49], 0 disables sync
+   */
+  inline void setSyncFrequency(float w) { sync_w_ = clip(w); }
+
+  /**
+   * @param width Pulse width, clipped to [0.02, 0.98]
+   */
+  inline void setPulseWidth(float width) { width_ = (width < 0.02f) ? 0.02f : (width > 0.98f) ? 0.98f : width; }
+
+  inline float getPhase(void) const { return phase_; }
+
+  /**
+   * Render a block.
+   *
+   * @param out Output samples
+   * @param frames Number of samples
+   * @param stride Distance between output samples, e.g. 4 for one lane of a frame-major buffer
+   */
+  fast_inline void process(float *out, size_t frames, size_t stride = 1) {
+    switch (shape_) {
+      case k_polyblep_pulse:
+        render<k_polyblep_pulse>(out, frames, stride);
+        break;
+      case k_polyblep_triangle:
+        render<k_polyblep_triangle>(out, frames, stride);
+        break;
+      default:
+        render<k_polyblep_saw>(out, frames, stride);
+        break;
+    }
+  }
+
+ private:
+  friend class PolyBlepQuad;
+
+  static constexpr size_t kRingSize = BlepResidual::kRingSize;
+  static constexpr size_t kRingMask = kRingSize - 1;
+
+  static inline float clip(float w) { return (w < 0.f) ? 0.f : (w > 0.49f) ? 0.49f : w; }
+
+  /**
+   * Corrections of a discontinuity at t samples before the current sample, t in [0, 1].
+   *
+   * @param h Step in value
+   * @param s Step in slope, per sample
+   */
+  fast_inline void discontinuity(float h, float s, float t) { BlepResidual::add(h, s, t, ring_, 1, pos_); }
+
+  template <PolyBlepShape Shape>
+  static fast_inline float value(float p, float width) {
+    switch (Shape) {
+      case k_polyblep_pulse:
+        return (p < width) ? 1.f : -1.f;
+      case k_polyblep_triangle:
+        return (p < 0.5f) ? 4.f * p - 1.f : 3.f - 4.f * p;
+      default:
+        return 2.f * p - 1.f;
+    }
+  }
+
+  /**
+   * Discontinuities crossed by the phase moving from a, at t0 samples before
+   * the current sample, until t1 samples before it.
+   */
+  template <PolyBlepShape Shape>
+  fast_inline void edges(float a, float t0, float t1) {
+    const float w = w_;
+    const float end = a + w * (t0 - t1);
+    switch (Shape) {
+      case k_polyblep_pulse:
+        if (a < width_ && end >= width_) discontinuity(-2.f, 0.f, t0 - (width_ - a) / w);
+        if (end >= 1.f) discontinuity(2.f, 0.f, t0 - (1.f - a) / w);
+        if (end >= 1.f + width_) discontinuity(-2.f, 0.f, t0 - (1.f + width_ - a) / w);
+        break;
+      case k_polyblep_triangle:
+        if (a < 0.5f && end >= 0.5f) discontinuity(0.f, -8.f * w, t0 - (0.5f - a) / w);
+        if (end >= 1.f) discontinuity(0.f, 8.f * w, t0 - (1.f - a) / w);
+        if (end >= 1.5f) discontinuity(0.f, -8.f * w, t0 - (1.5f - a) / w);
+        break;
+      default:
+        if (end >= 1.f) discontinuity(-2.f, 0.f, t0 - (1.f - a) / w);
+        break;
+    }
+  }
+
+  template <PolyBlepShape Shape>
+  fast_inline void render(float *out, size_t frames, size_t stride) {
+    const float w = w_;
+    const float sync_w = sync_w_;
+    float phase = phase_;
+    float master = master_;
+
+    // Note: pending output before the first sample holds the initial value
+    if (!primed_)
+      for (size_t d = 1; d <= BlepResidual::kDelay; ++d) ring_[(pos_ - d) & kRingMask] = value<Shape>(phase, width_);
+
+    for (size_t i = 0; i < frames; ++i, out += stride) {
+      master += sync_w;
+      if (master >= 1.f) {
+        master -= 1.f;
+        // Note: sync reset at tr samples before the current sample
+        const float tr = master / sync_w;
+        float pr = phase + w * (1.f - tr);
+        edges<Shape>(phase, 1.f, tr);
+        if (pr >= 1.f) pr -= 1.f;
+
+        float h, s;
+        switch (Shape) {
+          case k_polyblep_pulse:
+            h = (pr < width_) ? 0.f : 2.f;
+            s = 0.f;
+            break;
+          case k_polyblep_triangle:
+            h = -1.f - value<Shape>(pr, width_);
+            s = (pr < 0.5f) ? 0.f : 8.f * w;
+            break;
+          default:
+            h = -2.f * pr;
+            s = 0.f;
+            break;
+        }
+        discontinuity(h, s, tr);
+        edges<Shape>(0.f, tr, 0.f);
+        phase = w * tr;
+      } else {
+        edges<Shape>(phase, 1.f, 0.f);
+        phase += w;
+        if (phase >= 1.f) phase -= 1.f;
+      }
+
+      ring_[pos_] += value<Shape>(phase, width_);
+      float &y = ring_[(pos_ - BlepResidual::kDelay) & kRingMask];
+      *out = y;
+      y = 0.f;
+      pos_ = (pos_ + 1) & kRingMask;
+    }
+
+    phase_ = phase;
+    master_ = master;
+    primed_ = true;
+  }
+
+  PolyBlepShape shape_;
+  float w_;
+  float sync_w_;
+  float width_;
+
+  float phase_;
+  float master_;
+
+  // Note: samples with their corrections so far, output kDelay samples after the current one at pos_
+  float ring_[kRingSize];
+  size_t pos_;
+  bool primed_;
+};
+
+/**
+ * Four PolyBlepOsc oscillators of a common shape rendered together, e.g. the
+ * voices of a vector group. Same behavior as PolyBlepOsc per lane.
+ */
+class PolyBlepQuad {
+ public:
+  PolyBlepQuad(void) : shape_(k_polyblep_saw) {
+    for (size_t l = 0; l < 4; ++l) {
+      w_[l] = sync_w_[l] = 0.f;
+      width_[l] = 0.5f;
+    }
+    pos_ = 0;
+    reset();
+  }
+
+  /**
+   * Restart all phases and clear the correction state.
+   */
+  inline void reset(void) {
+    for (size_t l = 0; l < 4; ++l) reset(l);
+    primed_ = false;
+  }
+
+  /**
+   * Restart the phase of one lane, e.g. on note on. Pending corrections of the lane are dropped.
+   */
+  inline void reset(uint8_t lane) {
+    phase_[lane] = master_[lane] = 0.f;
+    const float start = (shape_ == k_polyblep_pulse) ? 1.f : -1.f;
+    for (size_t i = 0; i < kRingSize; ++i) ring_[i][lane] = 0.f;
+    for (size_t d = 1; d <= BlepResidual::kDelay; ++d) ring_[(pos_ - d) & kRingMask][lane] = start;
+  }
+
+  inline void setShape(PolyBlepShape shape) { shape_ = shape; }
+
+  /**
+   * @param lane Oscillator index, 0 to 3
+   * @param w Frequency in cycles per sample, clipped to [0, 0.49]
+   */
+  inline void setFrequency(uint8_t lane, float w) { w_[lane] = PolyBlepOsc::clip(w); }
+
+  /**
+   * @param lane Oscillator index, 0 to 3
+   * @param w Master frequency in cycles per sample, clipped to [0, 0.49], 0 disables sync
+   */
+  inline void setSyncFrequency(uint8_t lane, float w) { sync_w_[lane] = PolyBlepOsc::clip(w); }
+
+  /**
+   * @param lane Oscillator index, 0 to 3
+   * @param width Pulse width, clipped to [0.02, 0.98]
+   */
+  inline void setPulseWidth(uint8_t lane, float width) {
+    width_[lane] = (width < 0.02f) ? 0.02f : (width > 0.98f) ? 0.98f : width;
+  }
+
+  /**
+   * Render a block, frame-major: out[4 * n + lane].
+   *
+   * @param out Output buffer of 4 * frames samples, 16 byte aligned
+   * @param frames Number of frames
+   */
+  fast_inline void process(float *out, size_t frames) {
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    switch (shape_) {
+      case k_polyblep_pulse:
+        render<k_polyblep_pulse>(out, frames);
+        break;
+      case k_polyblep_triangle:
+        render<k_polyblep_triangle>(out, frames);
+        break;
+      default:
+        render<k_polyblep_saw>(out, frames);
+        break;
+    }
+#else
+    for (size_t l = 0; l < 4; ++l) {
+      PolyBlepOsc osc;
+      osc.setShape(shape_);
+      load(osc, l);
+      osc.process(out + l, frames, 4);
+      store(osc, l);
+    }
+    pos_ = (pos_ + frames) & kRingMask;
+    primed_ = true;
+#endif
+  }
+
+ private:
+  static constexpr size_t kRingSize = BlepResidual::kRingSize;
+  static constexpr size_t kRingMask = kRingSize - 1;
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+  /**
+   * Masked discontinuity corrections, see PolyBlepOsc::discontinuity().
+   */
+  fast_inline void discontinuity(uint32x4_t mask, float32x4_t h, float32x4_t s, float32x4_t t) {
+    // Note: events are rare, test for any lane before going through the lanes, t is not finite
+    //       in lanes without an event at zero frequency and is not used there
+    const float32x4_t on = vbslq_f32(mask, vdupq_n_f32(1.f), vdupq_n_f32(0.f));
+    const float32x2_t any = vpadd_f32(vget_low_f32(on), vget_high_f32(on));
+    if (vget_lane_f32(vpadd_f32(any, any), 0) == 0.f) return;
+
+    float lanes[4][4] __attribute__((aligned(16)));
+    vst1q_f32(lanes[0], on);
+    vst1q_f32(lanes[1], h);
+    vst1q_f32(lanes[2], s);
+    vst1q_f32(lanes[3], t);
+    for (size_t l = 0; l < 4; ++l)
+      if (lanes[0][l] != 0.f) BlepResidual::add(lanes[1][l], lanes[2][l], lanes[3][l], &ring_[0][l], 4, pos_);
+  }
+
+  template <PolyBlepShape Shape>
+  static fast_inline float32x4_t value(float32x4_t p, float32x4_t width) {
+    const float32x4_t one = vdupq_n_f32(1.f);
+    switch (Shape) {
+      case k_polyblep_pulse:
+        return vbslq_f32(vcltq_f32(p, width), one, vnegq_f32(one));
+      case k_polyblep_triangle: {
+        const float32x4_t four_p = vmulq_n_f32(p, 4.f);
+        return vbslq_f32(vcltq_f32(p, vdupq_n_f32(0.5f)), vsubq_f32(four_p, one),
+                         vsubq_f32(vdupq_n_f32(3.f), four_p));
+      }
+      default:
+        return vsubq_f32(vaddq_f32(p, p), one);
+    }
+  }
+
+  /**
+   * Threshold c crossed between phases a and end, at t0 - (c - a) / w samples before the current sample.
+   */
+  fast_inline void crossing(float32x4_t a, float32x4_t end, float32x4_t c, float32x4_t t0, float32x4_t inv_w,
+                            float32x4_t h, float32x4_t s) {
+    const uint32x4_t mask = vandq_u32(vcltq_f32(a, c), vcgeq_f32(end, c));
+    const float32x4_t t = vmlsq_f32(t0, vsubq_f32(c, a), inv_w);
+    discontinuity(mask, h, s, t);
+  }
+
+  template <PolyBlepShape Shape>
+  fast_inline void edges(float32x4_t a, float32x4_t end, float32x4_t t0, float32x4_t w, float32x4_t width,
+                         float32x4_t inv_w) {
+    const float32x4_t zero = vdupq_n_f32(0.f);
+    const float32x4_t one = vdupq_n_f32(1.f);
+    switch (Shape) {
+      case k_polyblep_pulse: {
+        const float32x4_t fall = vdupq_n_f32(-2.f);
+        crossing(a, end, width, t0, inv_w, fall, zero);
+        crossing(a, end, one, t0, inv_w, vdupq_n_f32(2.f), zero);
+        crossing(a, end, vaddq_f32(one, width), t0, inv_w, fall, zero);
+        break;
+      }
+      case k_polyblep_triangle: {
+        const float32x4_t down = vmulq_n_f32(w, -8.f);
+        crossing(a, end, vdupq_n_f32(0.5f), t0, inv_w, zero, down);
+        crossing(a, end, one, t0, inv_w, zero, vnegq_f32(down));
+        crossing(a, end, vdupq_n_f32(1.5f), t0, inv_w, zero, down);
+        break;
+      }
+      default:
+        crossing(a, end, one, t0, inv_w, vdupq_n_f32(-2.f), zero);
+        break;
+    }
+  }
+
+  static fast_inline float32x4_t reciprocal(float32x4_t x) {
+    // Note: two Newton-Raphson steps, zero for zero frequencies like PolyBlepOsc::setFrequency()
+    float32x4_t r = vrecpeq_f32(x);
+    r = vmulq_f32(vrecpsq_f32(x, r), r);
+    r = vmulq_f32(vrecpsq_f32(x, r), r);
+    return vbslq_f32(vcgtq_f32(x, vdupq_n_f32(0.f)), r, vdupq_n_f32(0.f));
+  }
+
+  template <PolyBlepShape Shape>
+  fast_inline void render(float *out, size_t frames) {
+    const float32x4_t zero = vdupq_n_f32(0.f);
+    const float32x4_t one = vdupq_n_f32(1.f);
+    const float32x4_t w = vld1q_f32(w_);
+    const float32x4_t sync_w = vld1q_f32(sync_w_);
+    const float32x4_t width = vld1q_f32(width_);
+    const float32x4_t inv_w = reciprocal(w);
+    const float32x4_t inv_sync_w = reciprocal(sync_w);
+    const uint32x4_t synced = vcgtq_f32(sync_w, zero);
+
+    float32x4_t phase = vld1q_f32(phase_);
+    float32x4_t master = vld1q_f32(master_);
+
+    // Note: pending output before the first sample holds the initial value
+    if (!primed_)
+      for (size_t d = 1; d <= BlepResidual::kDelay; ++d)
+        vst1q_f32(ring_[(pos_ - d) & kRingMask], value<Shape>(phase, width));
+
+    for (size_t i = 0; i < frames; ++i, out += 4) {
+      // Sync resets, at tr samples before the current sample
+      master = vaddq_f32(master, sync_w);
+      const uint32x4_t reset = vandq_u32(synced, vcgeq_f32(master, one));
+      master = vbslq_f32(reset, vsubq_f32(master, one), master);
+      const float32x4_t tr = vbslq_f32(reset, vmulq_f32(master, inv_sync_w), zero);
+
+      // Free running phase until the reset, or the whole sample
+      const float32x4_t end = vmlaq_f32(phase, w, vsubq_f32(one, tr));
+      edges<Shape>(phase, end, one, w, width, inv_w);
+      const float32x4_t pr = vbslq_f32(vcgeq_f32(end, one), vsubq_f32(end, one), end);
+
+      // Reset discontinuity and the restarted phase
+      float32x4_t h, s;
+      switch (Shape) {
+        case k_polyblep_pulse:
+          h = vbslq_f32(vcltq_f32(pr, width), zero, vdupq_n_f32(2.f));
+          s = zero;
+          break;
+        case k_polyblep_triangle:
+          h = vsubq_f32(vnegq_f32(one), value<Shape>(pr, width));
+          s = vbslq_f32(vcltq_f32(pr, vdupq_n_f32(0.5f)), zero, vmulq_n_f32(w, 8.f));
+          break;
+        default:
+          h = vmulq_n_f32(pr, -2.f);
+          s = zero;
+          break;
+      }
+      discontinuity(reset, h, s, tr);
+      const float32x4_t restart = vmulq_f32(w, tr);
+      switch (Shape) {
+        case k_polyblep_pulse:
+          crossing(zero, restart, width, tr, inv_w, vdupq_n_f32(-2.f), zero);
+          break;
+        case k_polyblep_triangle:
+          crossing(zero, restart, vdupq_n_f32(0.5f), tr, inv_w, zero, vmulq_n_f32(w, -8.f));
+          break;
+        default:
+          break;
+      }
+      phase = vbslq_f32(reset, restart, pr);
+
+      vst1q_f32(ring_[pos_], vaddq_f32(vld1q_f32(ring_[pos_]), value<Shape>(phase, width)));
+      float *y = ring_[(pos_ - BlepResidual::kDelay) & kRingMask];
+      vst1q_f32(out, vld1q_f32(y));
+      vst1q_f32(y, zero);
+      pos_ = (pos_ + 1) & kRingMask;
+    }
+
+    vst1q_f32(phase_, phase);
+    vst1q_f32(master_, master);
+    primed_ = true;
+  }
+#else
+  inline void load(PolyBlepOsc &osc, size_t lane) const {
+    osc.w_ = w_[lane];
+    osc.sync_w_ = sync_w_[lane];
+    osc.width_ = width_[lane];
+    osc.phase_ = phase_[lane];
+    osc.master_ = master_[lane];
+    for (size_t i = 0; i < kRingSize; ++i) osc.ring_[i] = ring_[i][lane];
+    osc.pos_ = pos_;
+    osc.primed_ = primed_;
+  }
+
+  inline void store(const PolyBlepOsc &osc, size_t lane) {
+    phase_[lane] = osc.phase_;
+    master_[lane] = osc.master_;
+    for (size_t i = 0; i < kRingSize; ++i) ring_[i][lane] = osc.ring_[i];
+  }
+#endif
+
+  PolyBlepShape shape_;
+  bool primed_;
+
+  float w_[4] __attribute__((aligned(16)));
+  float sync_w_[4] __attribute__((aligned(16)));
+  float width_[4] __attribute__((aligned(16)));
+  float phase_[4] __attribute__((aligned(16)));
+  float master_[4] __attribute__((aligned(16)));
+
+  // Note: frame-major samples with their corrections so far, see PolyBlepOsc
+  float ring_[kRingSize][4] __attribute__((aligned(16)));
+  size_t pos_;
+};
+
+}  // namespace dsp
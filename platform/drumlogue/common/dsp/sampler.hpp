@@ -0,0 +1,329 @@
+#pragma once
+/**
+ * @file sampler.hpp
+ * @brief Sample playback with octave mipmaps and windowed sinc interpolation
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "attributes.h"
+#include "sample_wrapper.h"
+#include "window.hpp"
+
+namespace dsp {
+
+/**
+ * One channel of a sample and its decimated octaves.
+ *
+ * Level 0 reads the sample memory in place. Level L holds the sample
+ * lowpassed and decimated by 2^L, each level computed from the previous one
+ * with a halfband filter at init(), so that playback at up to 2^L times the
+ * original rate can read level L without aliasing. Levels are stored in
+ * memory provided by the caller.
+ */
+class SampleMipmap {
+ public:
+  /** Maximum number of decimated levels, pitch shifting up to 8 octaves is alias free */
+  static constexpr size_t kMaxLevels = 8;
+
+  /** Zero samples around each decimated level, covering the interpolation kernel */
+  static constexpr size_t kPadding = 8;
+
+  /**
+   * Decimated level geometry.
+   */
+  struct Level {
+    const float *data;
+    size_t frames;
+    size_t stride;
+  };
+
+  SampleMipmap(void) : levels_(0) {}
+
+  /**
+   * Memory needed for a sample length.
+   *
+   * @param frames Sample length in frames
+   * @return Size in floats
+   */
+  static constexpr size_t memorySize(size_t frames) { return levelsSize(frames, 1); }
+
+  /**
+   * Build the mipmap of one channel of a sample, e.g. obtained with the runtime's get_sample(bank, index).
+   *
+   * Filters the whole sample, call from initialization or parameter
+   * callbacks, not from the render callback.
+   *
+   * @param sample Sample wrapper, must stay valid while the mipmap is used
+   * @param channel Channel of the sample to use
+   * @param ram Buffer of memorySize(sample->frames) floats
+   * @return False if the sample is null or empty
+   */
+  inline bool init(const sample_wrapper_t *sample, uint8_t channel, float *ram) {
+    levels_ = 0;
+    if (!sample || !sample->sample_ptr || sample->frames == 0 || sample->channels == 0) return false;
+    if (channel >= sample->channels) channel = sample->channels - 1;
+
+    level_[0].data = sample->sample_ptr + channel;
+    level_[0].frames = sample->frames;
+    level_[0].stride = sample->channels;
+    levels_ = 1;
+
+    while (levels_ <= kMaxLevels && level_[levels_ - 1].frames > kPadding) {
+      const Level &src = level_[levels_ - 1];
+      const size_t frames = (src.frames + 1) / 2;
+      float *dst = ram + kPadding;
+      for (size_t i = 0; i < kPadding; ++i) dst[-1 - i] = dst[frames + i] = 0.f;
+      decimate(src, dst, frames);
+
+      level_[levels_].data = dst;
+      level_[levels_].frames = frames;
+      level_[levels_].stride = 1;
+      ram += frames + 2 * kPadding;
+      ++levels_;
+    }
+    return true;
+  }
+
+  /**
+   * @return Number of levels including the original sample, 0 if not initialized
+   */
+  inline size_t getLevels(void) const { return levels_; }
+
+  inline const Level &getLevel(size_t level) const { return level_[level]; }
+
+  /**
+   * @return Length of the original sample in frames
+   */
+  inline size_t getFrames(void) const { return levels_ ? level_[0].frames : 0; }
+
+ private:
+  // Note: halfband lowpass, odd length, even offsets from the center are zero except the center tap
+  static constexpr size_t kHalfbandTaps = 63;
+  static constexpr size_t kHalfbandCenter = kHalfbandTaps / 2;
+  static constexpr float kHalfbandBeta = 8.f;
+
+  static constexpr size_t levelsSize(size_t frames, size_t level) {
+    return (level > kMaxLevels || frames <= kPadding)
+               ? 0
+               : (frames + 1) / 2 + 2 * kPadding + levelsSize((frames + 1) / 2, level + 1);
+  }
+
+  static inline void decimate(const Level &src, float *dst, size_t frames) {
+    // Note: odd taps of the halfband kernel, offsets 1, 3, .. from the center
+    float h[(kHalfbandCenter + 1) / 2];
+    float sum = 0.5f;
+    for (size_t k = 0; k < (kHalfbandCenter + 1) / 2; ++k) {
+      const float x = 2.f * k + 1.f;
+      const float w = kaiser_window(x / (kHalfbandCenter + 1), kHalfbandBeta);
+      h[k] = sinf(0.5f * M_PI * x) / (M_PI * x) * w;
+      sum += 2.f * h[k];
+    }
+    // Note: unity gain at DC
+    for (size_t k = 0; k < (kHalfbandCenter + 1) / 2; ++k) h[k] /= sum;
+    const float center = 0.5f / sum;
+
+    const float *x = src.data;
+    const size_t stride = src.stride;
+    const long n = static_cast<long>(src.frames);
+    for (size_t i = 0; i < frames; ++i) {
+      const long c = 2 * static_cast<long>(i);
+      float acc = center * x[c * stride];
+      for (size_t k = 0; k < (kHalfbandCenter + 1) / 2; ++k) {
+        const long o = 2 * static_cast<long>(k) + 1;
+        if (c - o >= 0) acc += h[k] * x[(c - o) * stride];
+        if (c + o < n) acc += h[k] * x[(c + o) * stride];
+      }
+      dst[i] = acc;
+    }
+  }
+
+  size_t levels_;
+  Level level_[kMaxLevels + 1];
+};
+
+/**
+ * Sample playback voice over a SampleMipmap.
+ *
+ * The level is chosen per block from the playback rate so that the rate
+ * within the level stays at or below 1, and samples are interpolated with
+ * a 16 tap Kaiser windowed sinc kernel, and exact integer positions read
+ * the level directly. Cost per output sample is fixed,
+ * independent of the rate. Rates above 2^SampleMipmap::kMaxLevels read the
+ * highest level and alias.
+ */
+class SamplerVoice {
+ public:
+  /** Interpolation kernel length */
+  static constexpr size_t kTaps = 16;
+
+  SamplerVoice(void) : mipmap_(nullptr), pos_(0), frac_(0.f), rate_(1.f), active_(false) {}
+
+  /**
+   * @param mipmap Sample to play, nullptr stops playback
+   */
+  inline void setSample(const SampleMipmap *mipmap) {
+    mipmap_ = mipmap;
+    if (!mipmap_ || mipmap_->getLevels() == 0) active_ = false;
+  }
+
+  /**
+   * Start playback.
+   *
+   * @param start Start position in frames of the original sample
+   */
+  inline void trigger(size_t start = 0) {
+    pos_ = start;
+    frac_ = 0.f;
+    active_ = mipmap_ && start < mipmap_->getFrames();
+  }
+
+  inline void stop(void) { active_ = false; }
+
+  inline bool isActive(void) const { return active_; }
+
+  /**
+   * @param rate Playback rate, original sample frames per output frame, e.g. 2 for one octave up
+   */
+  inline void setRate(float rate) { rate_ = (rate > 0.f) ? rate : 0.f; }
+
+  /**
+   * @param semitones Pitch shift from the original sample pitch
+   */
+  inline void setPitch(float semitones) { setRate(exp2f(semitones * (1.f / 12.f))); }
+
+  /**
+   * @return Playback position in frames of the original sample
+   */
+  inline size_t getPosition(void) const { return pos_; }
+
+  /**
+   * Render a mono block, zero after the end of the sample.
+   *
+   * @param out Output samples
+   * @param frames Number of samples
+   */
+  fast_inline void process(float *out, size_t frames) {
+    size_t i = 0;
+    if (active_) {
+      // Note: level with a rate in (0.5, 1], level 0 below
+      size_t level = 0;
+      float rate = rate_;
+      const size_t last = mipmap_->getLevels() - 1;
+      while (rate > 1.f && level < last) {
+        rate *= 0.5f;
+        ++level;
+      }
+
+      const SampleMipmap::Level &l = mipmap_->getLevel(level);
+      const size_t end = mipmap_->getFrames();
+      const size_t mask = (static_cast<size_t>(1) << level) - 1;
+      const float scale = 1.f / (mask + 1);
+      const float *table = kernel();
+      // Note: the kernel is not an impulse at integer positions, read the level directly when every position is integer
+      const bool whole = (rate == 1.f);
+
+      for (; i < frames; ++i) {
+        if (pos_ >= end) {
+          active_ = false;
+          break;
+        }
+        const size_t idx = pos_ >> level;
+        const float f = ((pos_ & mask) + frac_) * scale;
+        out[i] = (whole && f == 0.f) ? l.data[idx * l.stride] : interpolate(l, idx, f, table);
+
+        // Note: integer and fractional position kept apart, exact for long samples
+        frac_ += rate_;
+        const size_t step = static_cast<size_t>(frac_);
+        pos_ += step;
+        frac_ -= step;
+      }
+    }
+    for (; i < frames; ++i) out[i] = 0.f;
+  }
+
+ private:
+  static constexpr size_t kPhases = 64;
+  static constexpr float kKernelBeta = 7.f;
+
+  /**
+   * Windowed sinc kernel, kPhases + 1 rows of kTaps taps for fractional positions in [0, 1].
+   */
+  static inline const float *kernel(void) {
+    struct Table {
+      Table(void) {
+        // Note: cutoff below Nyquist so that images of the upper band are in the stop band
+        const float cutoff = 0.9f;
+        for (size_t p = 0; p <= kPhases; ++p) {
+          float sum = 0.f;
+          for (size_t j = 0; j < kTaps; ++j) {
+            const float x = static_cast<float>(j) - (kTaps / 2 - 1) - static_cast<float>(p) / kPhases;
+            const float w = kaiser_window(x / (kTaps / 2), kKernelBeta);
+            const float s = (fabsf(x) < 1e-6f) ? 1.f : sinf(M_PI * cutoff * x) / (M_PI * cutoff * x);
+            taps[p][j] = s * w;
+            sum += taps[p][j];
+          }
+          for (size_t j = 0; j < kTaps; ++j) taps[p][j] /= sum;
+        }
+      }
+      float taps[kPhases + 1][kTaps] __attribute__((aligned(16)));
+    };
+    static const Table table;
+    return &table.taps[0][0];
+  }
+
+  static fast_inline float interpolate(const SampleMipmap::Level &l, size_t idx, float f, const float *table) {
+    // Gather the taps around idx, zero outside of the sample
+    float x[kTaps] __attribute__((aligned(16)));
+    const float *src = l.data;
+    if (idx >= kTaps / 2 - 1 && idx + kTaps / 2 < l.frames) {
+      src += (idx - (kTaps / 2 - 1)) * l.stride;
+      for (size_t j = 0; j < kTaps; ++j) x[j] = src[j * l.stride];
+    } else {
+      for (size_t j = 0; j < kTaps; ++j) {
+        const size_t k = idx + j - (kTaps / 2 - 1);
+        x[j] = (idx + j >= kTaps / 2 - 1 && k < l.frames) ? src[k * l.stride] : 0.f;
+      }
+    }
+
+    // Note: kernel linearly interpolated between adjacent phases
+    const float p = f * kPhases;
+    size_t row = static_cast<size_t>(p);
+    if (row >= kPhases) row = kPhases - 1;
+    const float t = p - row;
+    const float *k0 = table + row * kTaps;
+    const float *k1 = k0 + kTaps;
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    float32x4_t acc = vdupq_n_f32(0.f);
+    for (size_t j = 0; j < kTaps; j += 4) {
+      const float32x4_t a = vld1q_f32(k0 + j);
+      const float32x4_t w = vmlaq_n_f32(a, vsubq_f32(vld1q_f32(k1 + j), a), t);
+      acc = vmlaq_f32(acc, w, vld1q_f32(x + j));
+    }
+    const float32x2_t s = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+#else
+    float acc = 0.f;
+    for (size_t j = 0; j < kTaps; ++j) acc += (k0[j] + (k1[j] - k0[j]) * t) * x[j];
+    return acc;
+#endif
+  }
+
+  const SampleMipmap *mipmap_;
+  size_t pos_;
+  float frac_;
+  float rate_;
+  bool active_;
+};
+
+}  // namespace dsp
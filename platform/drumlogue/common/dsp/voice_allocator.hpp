@@ -0,0 +1,207 @@
+#pragma once
+/**
+ * @file voice_allocator.hpp
+ * @brief Polyphonic voice allocation with note tracking and voice stealing
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dsp {
+
+/**
+ * Voice stealing policies, used when a note on finds no idle voice.
+ */
+enum VoiceStealPolicy {
+  k_voice_steal_oldest = 0U,
+  k_voice_steal_quietest,
+  k_num_voice_steal_policies
+};
+
+/**
+ * Maps notes to voices for a polyphonic engine whose voice state is kept
+ * separately, e.g. in structure-of-arrays form indexed by voice.
+ *
+ * A voice is idle, held (note on received) or released (note off received,
+ * still sounding). Note ons use the lowest idle voice so that active voices
+ * stay packed in the first vector groups, a note already sounding is
+ * retriggered on its voice. Without idle voices a released voice is stolen
+ * before a held one, the policy chooses among them.
+ *
+ * The engine reports voice levels with setLevel() for the quietest policy,
+ * and returns voices whose release has ended with free().
+ *
+ * @tparam Voices Maximum number of voices, at most 32
+ */
+template <size_t Voices>
+class VoiceAllocator {
+ public:
+  static_assert(Voices > 0 && Voices <= 32, "Voice count must be between 1 and 32.");
+
+  /** Returned when no voice is affected */
+  static constexpr uint8_t kNoVoice = 0xFF;
+
+  VoiceAllocator(void) : policy_(k_voice_steal_oldest), polyphony_(Voices) { reset(); }
+
+  /**
+   * Set all voices idle.
+   */
+  inline void reset(void) {
+    for (size_t v = 0; v < Voices; ++v) {
+      state_[v] = k_idle;
+      note_[v] = 0;
+      stamp_[v] = 0;
+      level_[v] = 0.f;
+    }
+    counter_ = 0;
+  }
+
+  /**
+   * @param policy Voice stealing policy
+   */
+  inline void setPolicy(VoiceStealPolicy policy) { policy_ = policy; }
+
+  inline VoiceStealPolicy getPolicy(void) const { return policy_; }
+
+  /**
+   * Limit the number of voices used by note ons, voices above the limit are released.
+   *
+   * @param voices Number of voices, clipped to [1, Voices]
+   */
+  inline void setPolyphony(size_t voices) {
+    polyphony_ = (voices < 1) ? 1 : (voices > Voices) ? Voices : voices;
+    for (size_t v = polyphony_; v < Voices; ++v)
+      if (state_[v] == k_held) state_[v] = k_released;
+  }
+
+  inline size_t getPolyphony(void) const { return polyphony_; }
+
+  /**
+   * Assign a voice to a note.
+   *
+   * @param note Note number
+   * @return Voice index, to be (re)triggered by the engine
+   */
+  inline uint8_t noteOn(uint8_t note) {
+    uint8_t voice = find(note);
+    if (voice == kNoVoice) voice = findIdle();
+    if (voice == kNoVoice) voice = steal();
+    state_[voice] = k_held;
+    note_[voice] = note;
+    stamp_[voice] = ++counter_;
+    return voice;
+  }
+
+  /**
+   * Release the voice holding a note.
+   *
+   * @param note Note number
+   * @return Released voice index, kNoVoice if the note is not held (e.g. its voice was stolen)
+   */
+  inline uint8_t noteOff(uint8_t note) {
+    for (size_t v = 0; v < Voices; ++v) {
+      if (state_[v] == k_held && note_[v] == note) {
+        state_[v] = k_released;
+        return v;
+      }
+    }
+    return kNoVoice;
+  }
+
+  /**
+   * Release all held voices.
+   */
+  inline void releaseAll(void) {
+    for (size_t v = 0; v < Voices; ++v)
+      if (state_[v] == k_held) state_[v] = k_released;
+  }
+
+  /**
+   * Return a voice to the idle pool, e.g. once its release envelope has ended.
+   *
+   * @param voice Voice index
+   */
+  inline void free(uint8_t voice) {
+    state_[voice] = k_idle;
+    level_[voice] = 0.f;
+  }
+
+  /**
+   * @param voice Voice index
+   * @param level Current output level of the voice, compared by the quietest policy
+   */
+  inline void setLevel(uint8_t voice, float level) { level_[voice] = level; }
+
+  inline bool isActive(uint8_t voice) const { return state_[voice] != k_idle; }
+
+  inline bool isHeld(uint8_t voice) const { return state_[voice] == k_held; }
+
+  inline bool isReleased(uint8_t voice) const { return state_[voice] == k_released; }
+
+  inline uint8_t getNote(uint8_t voice) const { return note_[voice]; }
+
+  /**
+   * @return Bit v set for each active voice v
+   */
+  inline uint32_t getActiveMask(void) const {
+    uint32_t mask = 0;
+    for (size_t v = 0; v < Voices; ++v)
+      if (state_[v] != k_idle) mask |= 1U << v;
+    return mask;
+  }
+
+ private:
+  enum {
+    k_idle = 0U,
+    k_held,
+    k_released
+  };
+
+  inline uint8_t find(uint8_t note) const {
+    for (size_t v = 0; v < polyphony_; ++v)
+      if (state_[v] != k_idle && note_[v] == note) return v;
+    return kNoVoice;
+  }
+
+  inline uint8_t findIdle(void) const {
+    for (size_t v = 0; v < polyphony_; ++v)
+      if (state_[v] == k_idle) return v;
+    return kNoVoice;
+  }
+
+  inline uint8_t steal(void) const {
+    // Note: released voices are stolen first, then held voices
+    uint8_t voice = select(k_released);
+    return (voice != kNoVoice) ? voice : select(k_held);
+  }
+
+  inline uint8_t select(uint8_t state) const {
+    uint8_t voice = kNoVoice;
+    for (size_t v = 0; v < polyphony_; ++v) {
+      if (state_[v] != state) continue;
+      if (voice == kNoVoice) {
+        voice = v;
+      } else if (policy_ == k_voice_steal_quietest) {
+        if (level_[v] < level_[voice]) voice = v;
+      } else {
+        // Note: wrap-safe comparison of note on stamps
+        if (static_cast<int32_t>(stamp_[v] - stamp_[voice]) < 0) voice = v;
+      }
+    }
+    return voice;
+  }
+
+  VoiceStealPolicy policy_;
+  size_t polyphony_;
+  uint32_t counter_;
+
+  uint8_t state_[Voices];
+  uint8_t note_[Voices];
+  uint32_t stamp_[Voices];
+  float level_[Voices];
+};
+
+}  // namespace dsp
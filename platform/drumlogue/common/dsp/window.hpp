@@ -0,0 +1,37 @@
+#pragma once
+/**
+ * @file window.hpp
+ * @brief Window functions for filter kernels built at init
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cmath>
+
+namespace dsp {
+
+// Note: power series of the zeroth order modified Bessel function, converges quickly for the betas used here
+inline float bessel_i0(float x) {
+  float sum = 1.f;
+  float term = 1.f;
+  const float q = 0.25f * x * x;
+  for (int k = 1; k < 32 && term > 1e-8f * sum; ++k) {
+    term *= q / (k * k);
+    sum += term;
+  }
+  return sum;
+}
+
+/**
+ * Kaiser window.
+ *
+ * @param x Position relative to the half length, in [-1, 1]
+ * @param beta Shape, larger values trade a wider transition band for a lower stop band
+ */
+inline float kaiser_window(float x, float beta) {
+  const float r = 1.f - x * x;
+  return bessel_i0(beta * sqrtf((r > 0.f) ? r : 0.f)) / bessel_i0(beta);
+}
+
+}  // namespace dsp
@@ -0,0 +1,269 @@
+#pragma once
+/**
+ * @file event_queue.hpp
+ * @brief Wait-free event queues between runtime callbacks and the render callback
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "attributes.h"
+
+namespace utils {
+
+/**
+ * Single producer, single consumer ring buffer. push() and pop() are
+ * wait-free, neither side ever blocks the other.
+ *
+ * @tparam T Element type, trivially copyable
+ * @tparam Capacity Maximum number of queued elements, power of two
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+ public:
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+  SpscQueue(void) : head_(0), tail_(0) {}
+
+  /**
+   * Append an element, producer side.
+   *
+   * @return False if the queue is full, the element is dropped
+   */
+  inline bool push(const T &item) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+    items_[tail & kMask] = item;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Oldest element, consumer side.
+   *
+   * @return Pointer to the element, valid until pop(), or nullptr if the queue is empty
+   */
+  inline const T *front(void) const {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return nullptr;
+    return &items_[head & kMask];
+  }
+
+  /**
+   * Remove the oldest element, consumer side. The queue must not be empty.
+   */
+  inline void pop(void) { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  /**
+   * Remove the oldest element, consumer side.
+   *
+   * @return False if the queue is empty
+   */
+  inline bool pop(T &item) {
+    const T *p = front();
+    if (!p) return false;
+    item = *p;
+    pop();
+    return true;
+  }
+
+  /**
+   * Drop all queued elements, consumer side.
+   */
+  inline void clear(void) { head_.store(tail_.load(std::memory_order_acquire), std::memory_order_release); }
+
+ private:
+  static constexpr uint32_t kMask = Capacity - 1;
+
+  // Note: indices on separate cache lines, written by one side each
+  alignas(64) std::atomic<uint32_t> head_;
+  alignas(64) std::atomic<uint32_t> tail_;
+  T items_[Capacity];
+};
+
+/**
+ * Events forwarded from runtime callbacks to the render callback.
+ */
+enum UnitEventType {
+  k_unit_event_param = 0U,    /**< index: parameter id, value: parameter value */
+  k_unit_event_tempo,         /**< value: tempo, 16.16 fixed point bpm */
+  k_unit_event_note_on,       /**< index: note, value: velocity */
+  k_unit_event_note_off,      /**< index: note */
+  k_unit_event_gate_on,       /**< value: velocity */
+  k_unit_event_gate_off,      /**< no arguments */
+  k_unit_event_all_note_off,  /**< no arguments */
+  k_unit_event_pitch_bend,    /**< value: 14 bit bend, centered at 0x2000 */
+  k_unit_event_channel_pressure,  /**< value: pressure */
+  k_unit_event_aftertouch,    /**< index: note, value: aftertouch */
+  k_num_unit_event_types
+};
+
+/**
+ * Timestamped event, time is in samples on the clock of EventClock.
+ */
+struct UnitEvent {
+  uint32_t time;
+  uint8_t type;
+  uint8_t index;
+  int32_t value;
+};
+
+/**
+ * Sample clock shared by the render callback and the callbacks posting events.
+ *
+ * The render callback publishes the sample position and wall clock time of
+ * each block start. Other threads convert the time at which their callback
+ * runs to a sample position, delayed by one buffer so that the event falls
+ * into the next block at the same offset it arrived at during the current
+ * one. Events are thus rendered with a constant latency of one buffer
+ * instead of being quantized to buffer boundaries.
+ */
+class EventClock {
+ public:
+  EventClock(void) : samplerate_(48000), latency_(64), position_(0), block_(kNotStarted) {}
+
+  /**
+   * @param samplerate Sample rate in Hz
+   * @param frames_per_buffer Nominal render buffer size, used as latency
+   */
+  inline void init(uint32_t samplerate, uint32_t frames_per_buffer) {
+    samplerate_ = samplerate;
+    latency_ = (frames_per_buffer > 0) ? frames_per_buffer : 1;
+  }
+
+  /**
+   * Publish the start of a block, render thread.
+   *
+   * @param frames Block size
+   * @return Sample position of the block start
+   */
+  inline uint32_t beginBlock(uint32_t frames) {
+    const uint32_t start = position_;
+    position_ += frames;
+    block_.store((static_cast<uint64_t>(start) << 32) | nowMicros(), std::memory_order_release);
+    return start;
+  }
+
+  /**
+   * Sample position at which an event posted now should be rendered, any thread.
+   */
+  inline uint32_t now(void) const {
+    const uint64_t block = block_.load(std::memory_order_acquire);
+    // Note: events posted before the first block, e.g. during initialization, start with it
+    if (block == kNotStarted) return 0;
+    const uint32_t elapsed_us = nowMicros() - static_cast<uint32_t>(block);
+    uint64_t elapsed = static_cast<uint64_t>(elapsed_us) * samplerate_ / 1000000U;
+    // Note: late render callbacks are absorbed by clamping to the end of the next block
+    if (elapsed >= latency_) elapsed = latency_ - 1;
+    return static_cast<uint32_t>(block >> 32) + latency_ + static_cast<uint32_t>(elapsed);
+  }
+
+ private:
+  static constexpr uint64_t kNotStarted = ~0ULL;
+
+  static inline uint32_t nowMicros(void) {
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+
+  uint32_t samplerate_;
+  uint32_t latency_;
+  uint32_t position_;
+
+  // Note: block start sample position in the upper half, wall clock microseconds in the lower half
+  std::atomic<uint64_t> block_;
+};
+
+/**
+ * Event queue of a unit: control events (parameters, tempo) and note events
+ * are posted from their runtime callbacks, possibly on different threads,
+ * and drained in time order by the render callback at block start.
+ *
+ * Each kind has its own single producer queue, so the two callback groups
+ * may run concurrently. Events posted to a full queue are dropped.
+ *
+ * @tparam Capacity Capacity of each queue, power of two
+ */
+template <size_t Capacity = 64>
+class UnitEventQueue {
+ public:
+  /**
+   * @param samplerate Sample rate in Hz
+   * @param frames_per_buffer Nominal render buffer size
+   */
+  inline void init(uint32_t samplerate, uint32_t frames_per_buffer) { clock_.init(samplerate, frames_per_buffer); }
+
+  /**
+   * Post an event stamped with the current time, callback side.
+   *
+   * @return False if the event was dropped
+   */
+  inline bool post(UnitEventType type, uint8_t index = 0, int32_t value = 0) {
+    const UnitEvent event = {clock_.now(), static_cast<uint8_t>(type), index, value};
+    return (type <= k_unit_event_tempo) ? control_.push(event) : notes_.push(event);
+  }
+
+  /**
+   * Start a block, render side.
+   *
+   * @param frames Block size
+   * @return Sample position of the block start
+   */
+  inline uint32_t beginBlock(uint32_t frames) {
+    start_ = clock_.beginBlock(frames);
+    end_ = start_ + frames;
+    return start_;
+  }
+
+  /**
+   * Next event due in the current block, oldest first, render side.
+   *
+   * @param event Destination
+   * @param offset Frame offset of the event in the block
+   * @return False if no more events are due in this block
+   */
+  inline bool next(UnitEvent &event, uint32_t &offset) {
+    const UnitEvent *c = control_.front();
+    const UnitEvent *n = notes_.front();
+    if (c && !due(*c)) c = nullptr;
+    if (n && !due(*n)) n = nullptr;
+    if (!c && !n) return false;
+
+    // Note: control events first on ties, so that notes use parameters set at the same time
+    if (c && (!n || static_cast<int32_t>(c->time - n->time) <= 0)) {
+      event = *c;
+      control_.pop();
+    } else {
+      event = *n;
+      notes_.pop();
+    }
+    // Note: events stamped before the block start apply at its start
+    offset = (static_cast<int32_t>(event.time - start_) > 0) ? event.time - start_ : 0;
+    return true;
+  }
+
+  /**
+   * Drop all pending events, render side.
+   */
+  inline void clear(void) {
+    control_.clear();
+    notes_.clear();
+  }
+
+ private:
+  inline bool due(const UnitEvent &event) const { return static_cast<int32_t>(event.time - end_) < 0; }
+
+  EventClock clock_;
+  uint32_t start_ = 0;
+  uint32_t end_ = 0;
+  SpscQueue<UnitEvent, Capacity> control_;
+  SpscQueue<UnitEvent, Capacity> notes_;
+};
+
+}  // namespace utils
@@ -0,0 +1,55 @@
+#pragma once
+/**
+ * @file event_render.hpp
+ * @brief Sample accurate event scheduling inside a render buffer
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "attributes.h"
+#include "utils/event_queue.hpp"
+
+namespace utils {
+
+/**
+ * Render a buffer in sub-blocks split at the timestamps of the events due in it.
+ *
+ * Events are applied in time order between the sub-blocks, so that their
+ * effect starts on the exact frame they are scheduled for regardless of the
+ * buffer size. Events sharing a timestamp are applied back to back without
+ * an empty sub-block between them.
+ *
+ * Example, with out an interleaved stereo buffer:
+ *
+ *   utils::render_split_at_events(events_, frames,
+ *       [this](const utils::UnitEvent &e) { applyEvent(e); },
+ *       [this, out](size_t offset, size_t n) { renderFrames(out + 2 * offset, n); });
+ *
+ * @param queue Event queue of the unit, see UnitEventQueue
+ * @param frames Buffer size
+ * @param apply Callable as apply(const UnitEvent &event)
+ * @param render Callable as render(size_t offset, size_t frames), renders frames starting at offset in the buffer
+ */
+template <typename Queue, typename Apply, typename Render>
+fast_inline void render_split_at_events(Queue &queue, size_t frames, Apply &&apply, Render &&render) {
+  queue.beginBlock(frames);
+
+  UnitEvent event;
+  uint32_t offset;
+  size_t pos = 0;
+  while (queue.next(event, offset)) {
+    // Note: offset is always below frames, only due events are returned
+    if (offset > pos) {
+      render(pos, offset - pos);
+      pos = offset;
+    }
+    apply(event);
+  }
+  if (pos < frames) render(pos, frames - pos);
+}
+
+}  // namespace utils
@@ -0,0 +1,255 @@
+#pragma once
+/**
+ * @file param_smoother.hpp
+ * @brief Block rate parameter smoothing configured from the unit header
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "attributes.h"
+#include "runtime.h"
+
+namespace utils {
+
+/**
+ * Smoothing modes of ParamSmoother.
+ */
+enum ParamSmoothMode {
+  k_param_smooth_none = 0U,  // value changes at the next block
+  k_param_smooth_one_pole,   // exponential approach, time is the time constant
+  k_param_smooth_linear,     // linear ramp, time is the duration of a full range ramp
+  k_num_param_smooth_modes
+};
+
+/**
+ * Smoothed parameter values of a unit, advanced once per block.
+ *
+ * Ranges, fractional formats and types are read from the unit_param_t table
+ * of the unit header. Values are returned in parameter units, e.g. 12.5 for
+ * a percent parameter with one fractional bit and raw value 25.
+ *
+ * Smoothing takes place in a perceptual domain chosen by the parameter type:
+ * hertz and khertz parameters are smoothed on a log frequency scale, db
+ * parameters linearly in dB, other continuous types linearly. Discrete types
+ * (none, enum, strings, bitmaps, onoff, midi_note, bpm) default to no
+ * smoothing.
+ *
+ * Render side only: call setValue() where the unit applies parameter
+ * changes, process() once per block, then use getValue() for the parameters
+ * flagged in the returned mask.
+ *
+ * @tparam NumParams Number of parameters, at most 32
+ */
+template <size_t NumParams = UNIT_MAX_PARAM_COUNT>
+class ParamSmoother {
+ public:
+  static_assert(NumParams > 0 && NumParams <= 32, "Parameter count must be between 1 and 32.");
+
+  /** Default smoothing time in seconds */
+  static constexpr float kDefaultTime = 0.02f;
+
+  ParamSmoother(void) : samplerate_(48000.f), pending_(0) {}
+
+  /**
+   * Configure all parameters from a parameter table and set them to their initial values.
+   *
+   * @param params Parameter table, e.g. unit_header.params
+   * @param count Number of parameters in the table
+   * @param samplerate Sample rate in Hz
+   */
+  inline void init(const unit_param_t *params, size_t count, float samplerate) {
+    samplerate_ = samplerate;
+    for (size_t i = 0; i < NumParams; ++i) {
+      const unit_param_t *p = (i < count) ? &params[i] : nullptr;
+      mode_[i] = p ? defaultMode(p->type) : k_param_smooth_none;
+      log_[i] = p && (p->type == k_unit_param_type_hertz || p->type == k_unit_param_type_khertz);
+      scale_[i] = p ? fracScale(*p) : 1.f;
+      time_[i] = kDefaultTime;
+
+      // Note: convergence threshold and ramp range in the smoothing domain
+      const float lo = toDomain(i, p ? p->min : 0);
+      const float hi = toDomain(i, p ? p->max : 0);
+      range_[i] = (hi > lo) ? hi - lo : 1.f;
+      epsilon_[i] = 1e-5f * range_[i];
+
+      current_[i] = target_[i] = toDomain(i, p ? p->init : 0);
+      value_[i] = fromDomain(i, current_[i]);
+      updateCoefficient(i);
+    }
+    pending_ = 0;
+  }
+
+  /**
+   * Configure all parameters from a unit header, see init(const unit_param_t *, size_t, float).
+   */
+  inline void init(const unit_header_t &header, float samplerate) {
+    init(header.params, header.num_params, samplerate);
+  }
+
+  /**
+   * Override the smoothing of a parameter.
+   *
+   * @param index Parameter index
+   * @param mode Smoothing mode
+   * @param seconds One pole time constant or full range linear ramp duration
+   */
+  inline void setSmoothing(uint8_t index, ParamSmoothMode mode, float seconds = kDefaultTime) {
+    if (index >= NumParams) return;
+    mode_[index] = mode;
+    time_[index] = (seconds > 1e-5f) ? seconds : 1e-5f;
+    updateCoefficient(index);
+  }
+
+  /**
+   * Set the target value of a parameter.
+   *
+   * @param index Parameter index
+   * @param value Raw parameter value, as passed to unit_set_param_value
+   */
+  inline void setValue(uint8_t index, int32_t value) {
+    if (index >= NumParams) return;
+    target_[index] = toDomain(index, value);
+    pending_ |= 1U << index;
+  }
+
+  /**
+   * Set a parameter immediately, bypassing smoothing, e.g. when loading a preset.
+   *
+   * @param index Parameter index
+   * @param value Raw parameter value
+   */
+  inline void jump(uint8_t index, int32_t value) {
+    if (index >= NumParams) return;
+    current_[index] = target_[index] = toDomain(index, value);
+    value_[index] = fromDomain(index, current_[index]);
+    pending_ |= 1U << index;
+  }
+
+  /**
+   * Advance all smoothed parameters by one block.
+   *
+   * @param frames Block size
+   * @return Bit i set for each parameter i whose value changed, to be recomputed by the unit
+   */
+  inline uint32_t process(size_t frames) {
+    const uint32_t changed = pending_;
+    if (!changed) return 0;
+
+    for (uint32_t bits = changed; bits; bits &= bits - 1) {
+      const size_t i = __builtin_ctz(bits);
+      const float delta = target_[i] - current_[i];
+      float step;
+      switch (mode_[i]) {
+        case k_param_smooth_one_pole:
+          step = (1.f - power(coef_[i], frames)) * delta;
+          break;
+        case k_param_smooth_linear:
+          step = (delta > 0.f) ? coef_[i] * frames : -coef_[i] * frames;
+          break;
+        default:
+          step = delta;
+          break;
+      }
+
+      if (fabsf(delta - step) <= epsilon_[i] || fabsf(step) >= fabsf(delta)) {
+        current_[i] = target_[i];
+        pending_ &= ~(1U << i);
+      } else {
+        current_[i] += step;
+      }
+      value_[i] = fromDomain(i, current_[i]);
+    }
+    return changed;
+  }
+
+  /**
+   * @param index Parameter index
+   * @return Current value in parameter units
+   */
+  inline float getValue(uint8_t index) const { return value_[index]; }
+
+  /**
+   * @param index Parameter index
+   * @return True while the value is moving towards its target
+   */
+  inline bool isSmoothing(uint8_t index) const { return pending_ & (1U << index); }
+
+ private:
+  static inline ParamSmoothMode defaultMode(uint8_t type) {
+    switch (type) {
+      case k_unit_param_type_percent:
+      case k_unit_param_type_db:
+      case k_unit_param_type_cents:
+      case k_unit_param_type_semi:
+      case k_unit_param_type_oct:
+      case k_unit_param_type_hertz:
+      case k_unit_param_type_khertz:
+      case k_unit_param_type_msec:
+      case k_unit_param_type_sec:
+      case k_unit_param_type_drywet:
+      case k_unit_param_type_pan:
+      case k_unit_param_type_spread:
+        return k_param_smooth_one_pole;
+      default:
+        return k_param_smooth_none;
+    }
+  }
+
+  static inline float fracScale(const unit_param_t &param) {
+    float scale = 1.f;
+    if (param.frac_mode == k_unit_param_frac_mode_decimal) {
+      for (uint8_t i = 0; i < param.frac; ++i) scale *= 0.1f;
+    } else {
+      scale /= static_cast<float>(1U << param.frac);
+    }
+    return scale;
+  }
+
+  inline float toDomain(size_t index, int32_t value) const {
+    const float v = value * scale_[index];
+    // Note: log frequency scale, clipped to stay finite for zero or negative frequencies
+    return log_[index] ? log2f((v > 1e-3f) ? v : 1e-3f) : v;
+  }
+
+  inline float fromDomain(size_t index, float x) const { return log_[index] ? exp2f(x) : x; }
+
+  inline void updateCoefficient(size_t index) {
+    const float samples = time_[index] * samplerate_;
+    coef_[index] = (mode_[index] == k_param_smooth_linear) ? range_[index] / samples : expf(-1.f / samples);
+  }
+
+  /**
+   * x^n by squaring, a few multiplies for any block size.
+   */
+  static inline float power(float x, size_t n) {
+    float y = 1.f;
+    for (; n; n >>= 1, x *= x)
+      if (n & 1) y *= x;
+    return y;
+  }
+
+  float samplerate_;
+  uint32_t pending_;
+
+  uint8_t mode_[NumParams];
+  bool log_[NumParams];
+  float scale_[NumParams];
+  float time_[NumParams];
+  float range_[NumParams];
+  float epsilon_[NumParams];
+
+  // Note: per frame one pole retention or linear increment, raised to or scaled by the block size in process()
+  float coef_[NumParams];
+
+  // Note: current and target in the smoothing domain, value_ in parameter units
+  float current_[NumParams];
+  float target_[NumParams];
+  float value_[NumParams];
+};
+
+}  // namespace utils
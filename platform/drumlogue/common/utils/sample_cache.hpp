@@ -0,0 +1,177 @@
+#pragma once
+/**
+ * @file sample_cache.hpp
+ * @brief Index of the runtime's sample banks, by bank/index and by name
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "runtime.h"
+
+namespace utils {
+
+/**
+ * Sample index built once, e.g. in unit_init, so that samples can be
+ * resolved in constant time from parameter callbacks instead of walking the
+ * banks through the runtime's accessors.
+ *
+ * Entries are stored contiguously, bank after bank, with a per bank offset
+ * table for bank/index lookups and an open addressing hash table of the
+ * sample names. Samples beyond the capacity are left out.
+ *
+ * @tparam MaxSamples Maximum number of indexed samples, power of two, at most 32768
+ * @tparam MaxBanks Maximum number of indexed banks
+ */
+template <size_t MaxSamples = 1024, size_t MaxBanks = 16>
+class SampleCache {
+ public:
+  static_assert(MaxSamples > 0 && MaxSamples <= 0x8000 && (MaxSamples & (MaxSamples - 1)) == 0,
+                "Sample count must be a power of two, at most 32768.");
+
+  /**
+   * Compact copy of a sample wrapper.
+   */
+  struct Entry {
+    const float *sample_ptr;
+    uint32_t frames;
+    uint32_t hash;
+    uint8_t bank;
+    uint8_t index;
+    uint8_t channels;
+    const sample_wrapper_t *wrapper;  // Note: for the name, and for APIs taking a sample wrapper
+  };
+
+  SampleCache(void) : num_samples_(0), num_banks_(0) { clear(); }
+
+  /**
+   * Index all samples available through the runtime.
+   *
+   * @param desc Runtime descriptor passed to unit_init
+   * @return False if some samples or banks did not fit and were left out
+   */
+  inline bool init(const unit_runtime_desc_t *desc) {
+    clear();
+    if (!desc->get_num_sample_banks || !desc->get_num_samples_for_bank || !desc->get_sample) return true;
+
+    bool complete = true;
+    size_t banks = desc->get_num_sample_banks();
+    if (banks > MaxBanks) {
+      banks = MaxBanks;
+      complete = false;
+    }
+
+    for (size_t b = 0; b < banks; ++b) {
+      bank_start_[b] = num_samples_;
+      const size_t count = desc->get_num_samples_for_bank(b);
+      for (size_t i = 0; i < count; ++i) {
+        if (num_samples_ == MaxSamples) {
+          complete = false;
+          break;
+        }
+        const sample_wrapper_t *w = desc->get_sample(b, i);
+        Entry &e = entries_[num_samples_];
+        e.wrapper = w;
+        e.sample_ptr = w ? w->sample_ptr : nullptr;
+        e.frames = w ? w->frames : 0;
+        e.channels = w ? w->channels : 0;
+        e.bank = b;
+        e.index = i;
+        e.hash = w ? hash(w->name) : 0;
+        if (w) insert(num_samples_);
+        ++num_samples_;
+      }
+      bank_count_[b] = num_samples_ - bank_start_[b];
+    }
+    num_banks_ = banks;
+    return complete;
+  }
+
+  /**
+   * Remove all entries.
+   */
+  inline void clear(void) {
+    num_samples_ = 0;
+    num_banks_ = 0;
+    std::memset(bank_start_, 0, sizeof(bank_start_));
+    std::memset(bank_count_, 0, sizeof(bank_count_));
+    std::memset(slots_, 0, sizeof(slots_));
+  }
+
+  inline size_t getNumSamples(void) const { return num_samples_; }
+
+  inline uint8_t getNumBanks(void) const { return num_banks_; }
+
+  inline uint8_t getNumSamplesForBank(uint8_t bank) const { return (bank < num_banks_) ? bank_count_[bank] : 0; }
+
+  /**
+   * @param i Flat index over all banks, e.g. a parameter value selecting any sample
+   * @return Entry, nullptr if out of range
+   */
+  inline const Entry *at(size_t i) const { return (i < num_samples_) ? &entries_[i] : nullptr; }
+
+  /**
+   * @param bank Bank index
+   * @param index Sample index within the bank
+   * @return Entry, nullptr if out of range
+   */
+  inline const Entry *get(uint8_t bank, uint8_t index) const {
+    if (bank >= num_banks_ || index >= bank_count_[bank]) return nullptr;
+    return &entries_[bank_start_[bank] + index];
+  }
+
+  /**
+   * @param name Sample name, compared exactly
+   * @return First entry with that name in bank order, nullptr if not found
+   */
+  inline const Entry *find(const char *name) const {
+    const uint32_t h = hash(name);
+    for (size_t s = h & kSlotMask;; s = (s + 1) & kSlotMask) {
+      const uint16_t slot = slots_[s];
+      if (slot == 0) return nullptr;
+      const Entry &e = entries_[slot - 1];
+      if (e.hash == h && std::strncmp(e.wrapper->name, name, UNIT_SAMPLE_WRAPPER_MAX_NAME_LEN + 1) == 0) return &e;
+    }
+  }
+
+ private:
+  // Note: at most half full, so that probe sequences stay short and always end on an empty slot
+  static constexpr size_t kSlots = 2 * MaxSamples;
+  static constexpr size_t kSlotMask = kSlots - 1;
+
+  /**
+   * FNV-1a hash of a sample name.
+   */
+  static inline uint32_t hash(const char *name) {
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; i <= UNIT_SAMPLE_WRAPPER_MAX_NAME_LEN && name[i]; ++i) {
+      h ^= static_cast<uint8_t>(name[i]);
+      h *= 16777619U;
+    }
+    return h;
+  }
+
+  inline void insert(size_t entry) {
+    // Note: duplicate names keep the first entry found by find(), later ones are only reachable by bank/index
+    size_t s = entries_[entry].hash & kSlotMask;
+    while (slots_[s] != 0) s = (s + 1) & kSlotMask;
+    slots_[s] = entry + 1;
+  }
+
+  size_t num_samples_;
+  uint8_t num_banks_;
+
+  uint16_t bank_start_[MaxBanks];
+  uint8_t bank_count_[MaxBanks];
+
+  Entry entries_[MaxSamples];
+
+  // Note: entry index + 1, 0 for empty slots
+  uint16_t slots_[kSlots];
+};
+
+}  // namespace utils
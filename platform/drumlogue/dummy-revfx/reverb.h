@@ -2,7 +2,7 @@
 /*
  *  File: reverb.h
  *
- *  Dummy Reverb Class
+ *  Dummy Reverb Class, feedback delay network reverb built on common/dsp
  *
  *  Author: Etienne Noreau-Hebert <etienne@korg.co.jp>
  *
@@ -11,12 +11,14 @@
  */
 
 #include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 
 #include <arm_neon.h>
 
 #include "unit.h"  // Note: Include common definitions for all units
+#include "dsp/fdn_reverb.hpp"
 
 class Reverb {
  public:
@@ -24,6 +26,16 @@ class Reverb {
   /* Public Data Structures/Types. */
   /*===========================================================================*/
 
+  enum {
+    TIME = 0U,
+    DAMP,
+    MIX,
+    PARAM_BLANK,
+    SIZE,
+    MOD,
+    NUM_PARAMS
+  };
+
   /*===========================================================================*/
   /* Lifecycle Methods. */
   /*===========================================================================*/
@@ -41,6 +53,11 @@ class Reverb {
       return k_unit_err_geometry;
 
     // Note: if need to allocate some memory can do it here and return k_unit_err_memory if getting allocation errors
+    //       Here the network runs in the fixed size member buffer fdn_memory_, no allocation takes place afterwards
+    fdn_.init(fdn_memory_, desc->samplerate);
+
+    for (uint8_t i = 0; i < NUM_PARAMS; ++i)
+      setParameter(i, params_[i]);
 
     return k_unit_err_none;
   }
@@ -51,6 +68,7 @@ class Reverb {
 
   inline void Reset() {
     // Note: Reset effect state.
+    fdn_.reset();
   }
 
   inline void Resume() {
@@ -68,31 +86,42 @@ class Reverb {
   /*===========================================================================*/
 
   fast_inline void Process(const float * in, float * out, size_t frames) {
-    const float * __restrict in_p = in;
-    float * __restrict out_p = out;
-    const float * out_e = out_p + (frames << 1);  // assuming stereo output
-
-    for (; out_p != out_e; in_p += 2, out_p += 2) {
-      // Note: should take advantage of NEON ArmV7 instructions
-      float32x2_t sig = vld1_f32(in_p);
-      vst1_f32(out_p, vmul_n_f32(sig, 0.f));
-    }
+    // Note: network is vectorized across lines with NEON ArmV7 instructions, see common/dsp/fdn_reverb.hpp
+    fdn_.process(in, out, frames);
   }
 
   inline void setParameter(uint8_t index, int32_t value) {
-    (void)value;
+    if (index >= NUM_PARAMS)
+      return;
+    params_[index] = value;
+
+    const float v = value * 0.01f;
     switch (index) {
+      case TIME:
+        // Note: exponential mapping from 0.2s to 20s
+        fdn_.setTime(0.2f * powf(100.f, v));
+        break;
+      case DAMP:
+        fdn_.setDamping(v);
+        break;
+      case MIX:
+        fdn_.setLevels(1.f - v, v);
+        break;
+      case SIZE:
+        fdn_.setSize(0.25f + 0.75f * v);
+        break;
+      case MOD:
+        fdn_.setModulation(v);
+        break;
       default:
         break;
     }
   }
 
   inline int32_t getParameterValue(uint8_t index) const {
-    switch (index) {
-      default:
-        break;
-    }
-    return 0;
+    if (index >= NUM_PARAMS)
+      return 0;
+    return params_[index];
   }
 
   inline const char * getParameterStrValue(uint8_t index, int32_t value) const {
@@ -144,7 +173,12 @@ class Reverb {
 
   std::atomic_uint_fast32_t flags_;
 
-  float reverb_line_[24000U << 1] __attribute__((aligned(16)));
+  dsp::FdnReverb<8> fdn_;
+
+  // Note: defaults match header.c
+  int32_t params_[NUM_PARAMS] = {40, 50, 25, 0, 70, 30};
+
+  float fdn_memory_[dsp::FdnReverb<8>::kMemorySize] __attribute__((aligned(16)));
 
   /*===========================================================================*/
   /* Private Methods. */
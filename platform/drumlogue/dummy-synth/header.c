@@ -19,33 +19,32 @@ const __unit_header unit_header_t unit_header = {
     .version = 0x00010000U,                                // This unit's version: major.minor.patch (major<<16 minor<<8 patch).
     .name = "dummy",                                       // Name for this unit, will be displayed on device
     .num_presets = 0,                                      // Number of internal presets this unit has
-    .num_params = 6,                                       // Number of parameters for this unit, max 24
+    .num_params = 7,                                       // Number of parameters for this unit, max 24
     .params = {
         // Format: min, max, center, default, type, fractional, frac. type, <reserved>, name
 
         // See common/runtime.h for type enum and unit_param_t structure
 
         // Page 1
-        // percent param with .5 precision e.g.: "25.0%", "50.5%"
-        {0, (100 << 1), 0, (25 << 1), k_unit_param_type_percent, 1, 0, 0, {"PARAM1"}},
-        // untyped bipolar parameter centered at 0 e.g.: "-5", "0", "2"
-        {-5, 5, 0, 0, k_unit_param_type_none, 0, 0, 0, {"PARAM2"}},
-        // pan parameter e.g.: "L50", "C", "R100"
-        {-100, 100, 0, 0, k_unit_param_type_pan, 0, 0, 0, {"PARAM3"}},
-        // blank parameter, leaves that parameter slot blank in UI. Use when
-        // want to align some params to next page
-        {0, 0, 0, 0, k_unit_param_type_none, 0, 0, 0, {""}},
+        // envelope attack time, exponentially mapped from 1ms to 2s
+        {0, 100, 0, 0, k_unit_param_type_percent, 0, 0, 0, {"ATTACK"}},
+        // envelope decay time, exponentially mapped from 5ms to 5s
+        {0, 100, 0, 40, k_unit_param_type_percent, 0, 0, 0, {"DECAY"}},
+        // envelope sustain level
+        {0, 100, 0, 70, k_unit_param_type_percent, 0, 0, 0, {"SUSTAIN"}},
+        // envelope release time, exponentially mapped from 5ms to 5s
+        {0, 100, 0, 30, k_unit_param_type_percent, 0, 0, 0, {"RELEASE"}},
 
         // Page 2
-        // string enum parameter, unit_get_param_str_value will be called with
+        // lowpass cutoff, exponentially mapped from 50Hz to 16kHz
+        {0, 100, 0, 60, k_unit_param_type_percent, 0, 0, 0, {"CUTOFF"}},
+        // maximum number of simultaneous voices
+        {1, 16, 0, 16, k_unit_param_type_none, 0, 0, 0, {"VOICES"}},
+        // voice stealing policy, unit_get_param_str_value will be called with
         // numerical value to obtain string to display
-        {0, 9, 0, 0, k_unit_param_type_strings, 0, 0, 0, {"PARAM4"}},
-        // bitmap enum parameter, unit_get_param_bmp_value will be called with
-        // numerical value to obtain the bitmap to display
-        // Note: bitmap specifications not final yet, and not implemented yet in
-        // UI
-        {0, 9, 0, 0, k_unit_param_type_bitmaps, 0, 0, 0, {"PARAM5"}},
-        {0, 0, 0, 0, k_unit_param_type_none, 0, 0, 0, {""}},
+        {0, 1, 0, 0, k_unit_param_type_strings, 0, 0, 0, {"STEAL"}},
+        // blank parameter, leaves that parameter slot blank in UI. Use when
+        // want to align some params to next page
         {0, 0, 0, 0, k_unit_param_type_none, 0, 0, 0, {""}},
 
         // Page 3
@@ -2,20 +2,26 @@
 /*
  *  File: synth.h
  *
- *  Dummy Synth Class.
+ *  Dummy Synth Class, polyphonic saw synth with voices rendered four at a time
  *
  *
  *  2021-2022 (c) Korg
  *
  */
 
-#include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include <arm_neon.h>
 
 #include "unit.h"  // Note: Include common definitions for all units
+#include "dsp/envelope.hpp"
+#include "dsp/voice_allocator.hpp"
+#include "utils/event_queue.hpp"
+#include "utils/event_render.hpp"
+#include "utils/param_smoother.hpp"
 
 class Synth {
  public:
@@ -23,6 +29,17 @@ class Synth {
   /* Public Data Structures/Types. */
   /*===========================================================================*/
 
+  enum {
+    ATTACK = 0U,
+    DECAY,
+    SUSTAIN,
+    RELEASE,
+    CUTOFF,
+    VOICES,
+    STEAL,
+    NUM_PARAMS
+  };
+
   /*===========================================================================*/
   /* Lifecycle Methods. */
   /*===========================================================================*/
@@ -41,6 +58,13 @@ class Synth {
 
     // Note: if need to allocate some memory can do it here and return k_unit_err_memory if getting allocation errors
 
+    events_.init(desc->samplerate, desc->frames_per_buffer);
+    smoother_.init(unit_header, desc->samplerate);
+
+    Reset();
+    for (uint8_t i = 0; i < NUM_PARAMS; ++i)
+      applyParameter(i, params_[i]);
+
     return k_unit_err_none;
   }
 
@@ -51,6 +75,15 @@ class Synth {
   inline void Reset() {
     // Note: Reset synth state. I.e.: Clear filter memory, reset oscillator
     // phase etc.
+    allocator_.reset();
+    std::memset(phase_, 0, sizeof(phase_));
+    std::memset(inc_, 0, sizeof(inc_));
+    std::memset(amp_, 0, sizeof(amp_));
+    std::memset(lp_z_, 0, sizeof(lp_z_));
+    for (size_t g = 0; g < kNumGroups; ++g)
+      env_[g].reset();
+    bend_ = 1.f;
+    tempo_ = 120.f;
   }
 
   inline void Resume() {
@@ -68,37 +101,38 @@ class Synth {
   /*===========================================================================*/
 
   fast_inline void Render(float * out, size_t frames) {
-    float * __restrict out_p = out;
-    const float * out_e = out_p + (frames << 1);  // assuming stereo output
-
-    for (; out_p != out_e; out_p += 2) {
-      // Note: should take advantage of NEON ArmV7 instructions
-      vst1_f32(out_p, vdup_n_f32(0.f));
-    }
+    // Note: events posted by other callbacks are applied on the frame they are scheduled for, see
+    //       common/utils/event_queue.hpp and common/utils/event_render.hpp
+    utils::render_split_at_events(
+        events_, frames, [this](const utils::UnitEvent & event) { applyEvent(event); },
+        [this, out](size_t offset, size_t n) { renderFrames(out + 2 * offset, n); });
   }
 
+  // Note: callbacks below may run concurrently with Render, they post events that Render applies
+
   inline void setParameter(uint8_t index, int32_t value) {
-    (void)value;
-    switch (index) {
-      default:
-        break;
-    }
+    if (index >= NUM_PARAMS)
+      return;
+    params_[index] = value;
+    events_.post(utils::k_unit_event_param, index, value);
   }
 
   inline int32_t getParameterValue(uint8_t index) const {
-    switch (index) {
-      default:
-        break;
-    }
-    return 0;
+    if (index >= NUM_PARAMS)
+      return 0;
+    return params_[index];
   }
 
   inline const char * getParameterStrValue(uint8_t index, int32_t value) const {
-    (void)value;
+    static const char * steal_names[dsp::k_num_voice_steal_policies] = {"OLDEST", "QUIETEST"};
     switch (index) {
       // Note: String memory must be accessible even after function returned.
       //       It can be assumed that caller will have copied or used the string
       //       before the next call to getParameterStrValue
+      case STEAL:
+        if (value >= 0 && value < dsp::k_num_voice_steal_policies)
+          return steal_names[value];
+        break;
       default:
         break;
     }
@@ -120,21 +154,22 @@ class Synth {
   }
 
   inline void NoteOn(uint8_t note, uint8_t velocity) {
-    (void)note;
-    (void)velocity;
+    events_.post(utils::k_unit_event_note_on, note, velocity);
   }
 
-  inline void NoteOff(uint8_t note) { (void)note; }
+  inline void NoteOff(uint8_t note) { events_.post(utils::k_unit_event_note_off, note); }
 
   inline void GateOn(uint8_t velocity) {
-    (void)velocity;
+    events_.post(utils::k_unit_event_gate_on, 0, velocity);
   }
 
-  inline void GateOff() {}
+  inline void GateOff() { events_.post(utils::k_unit_event_gate_off); }
 
-  inline void AllNoteOff() {}
+  inline void AllNoteOff() { events_.post(utils::k_unit_event_all_note_off); }
 
-  inline void PitchBend(uint16_t bend) { (void)bend; }
+  inline void PitchBend(uint16_t bend) {
+    events_.post(utils::k_unit_event_pitch_bend, 0, bend);
+  }
 
   inline void ChannelPressure(uint8_t pressure) { (void)pressure; }
 
@@ -143,6 +178,10 @@ class Synth {
     (void)aftertouch;
   }
 
+  inline void SetTempo(uint32_t tempo) {
+    events_.post(utils::k_unit_event_tempo, 0, tempo);
+  }
+
   inline void LoadPreset(uint8_t idx) { (void)idx; }
 
   inline uint8_t getPresetIndex() const { return 0; }
@@ -161,16 +200,241 @@ class Synth {
 
  private:
   /*===========================================================================*/
-  /* Private Member Variables. */
+  /* Constants. */
   /*===========================================================================*/
 
-  std::atomic_uint_fast32_t flags_;
+  static constexpr float kSampleRate = 48000.f;
+  static constexpr size_t kMaxVoices = 16;
+  static constexpr size_t kNumGroups = kMaxVoices / 4;
+  static constexpr size_t kBlockSize = 64;
+  static constexpr uint8_t kGateNote = 60;
+  static constexpr float kVoiceGain = 0.2f;
 
   /*===========================================================================*/
-  /* Private Methods. */
+  /* Private Member Variables. */
   /*===========================================================================*/
 
+  dsp::VoiceAllocator<kMaxVoices> allocator_;
+
+  // Note: defaults match header.c
+  int32_t params_[NUM_PARAMS] = {0, 40, 70, 30, 60, 16, 0};
+
+  // Note: callbacks post to events_, the state below is only accessed from Render
+  utils::UnitEventQueue<> events_;
+
+  utils::ParamSmoother<NUM_PARAMS> smoother_;
+
+  float cutoff_coef_;
+  float bend_;
+  float tempo_;
+
+  // Note: voice state in structure of arrays form, index v is voice v, lane v % 4 of group v / 4
+  float phase_[kMaxVoices] __attribute__((aligned(16)));
+  float inc_[kMaxVoices] __attribute__((aligned(16)));
+  float amp_[kMaxVoices] __attribute__((aligned(16)));
+  float lp_z_[kMaxVoices] __attribute__((aligned(16)));
+
+  // Note: one envelope generator per group, rendered a block at a time into env_buf_
+  dsp::AdsrQuad env_[kNumGroups];
+
+  float env_buf_[4 * kBlockSize] __attribute__((aligned(16)));
+  float mix_[kBlockSize] __attribute__((aligned(16)));
+
   /*===========================================================================*/
-  /* Constants. */
+  /* Private Methods. */
   /*===========================================================================*/
+
+  /**
+   * Render voices v to v + 3 and add their sum to the mix buffer.
+   */
+  fast_inline void renderGroup(size_t v, size_t frames) {
+    const float32x4_t one = vdupq_n_f32(1.f);
+    const float32x4_t cutoff = vdupq_n_f32(cutoff_coef_);
+    const float32x4_t inc = vmulq_n_f32(vld1q_f32(&inc_[v]), bend_);
+    const float32x4_t amp = vld1q_f32(&amp_[v]);
+
+    float32x4_t phase = vld1q_f32(&phase_[v]);
+    float32x4_t z = vld1q_f32(&lp_z_[v]);
+
+    // Envelopes, whole block at once, see common/dsp/envelope.hpp
+    env_[v >> 2].process(env_buf_, frames);
+
+    for (size_t i = 0; i < frames; ++i) {
+      // Saw oscillators
+      phase = vaddq_f32(phase, inc);
+      phase = vbslq_f32(vcgeq_f32(phase, one), vsubq_f32(phase, one), phase);
+      const float32x4_t saw = vsubq_f32(vaddq_f32(phase, phase), one);
+
+      // Lowpass filters
+      z = vmlaq_f32(z, cutoff, vsubq_f32(saw, z));
+
+      const float32x4_t y = vmulq_f32(vmulq_f32(z, vld1q_f32(&env_buf_[4 * i])), amp);
+      const float32x2_t s = vadd_f32(vget_low_f32(y), vget_high_f32(y));
+      mix_[i] += vget_lane_f32(vpadd_f32(s, s), 0);
+    }
+
+    vst1q_f32(&phase_[v], phase);
+    vst1q_f32(&lp_z_[v], z);
+  }
+
+  /**
+   * Render frames to an interleaved stereo buffer, in blocks of at most kBlockSize frames.
+   */
+  fast_inline void renderFrames(float * out, size_t frames) {
+    float * __restrict out_p = out;
+
+    while (frames > 0) {
+      size_t n = kBlockSize;
+      if (frames < n)
+        n = frames;
+      std::memset(mix_, 0, n * sizeof(float));
+
+      // Note: smoothed parameters are advanced once per block, see common/utils/param_smoother.hpp
+      if (smoother_.process(n) & (1U << CUTOFF))
+        updateCutoff();
+
+      // Note: only groups of four voices with at least one active voice are rendered
+      const uint32_t active = allocator_.getActiveMask();
+      for (size_t g = 0; g < kNumGroups; ++g) {
+        if (active & (0xFU << (4 * g)))
+          renderGroup(4 * g, n);
+      }
+      updateVoices(active);
+
+      // Note: mono mix to stereo output, 4 frames per iteration
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4, out_p += 8) {
+        float32x4x2_t v;
+        v.val[0] = v.val[1] = vld1q_f32(&mix_[i]);
+        vst2q_f32(out_p, v);
+      }
+      for (; i < n; ++i, out_p += 2)
+        vst1_f32(out_p, vdup_n_f32(mix_[i]));
+
+      frames -= n;
+    }
+  }
+
+  /**
+   * Report levels for voice stealing and free voices whose release has ended.
+   */
+  inline void updateVoices(uint32_t active) {
+    for (uint8_t v = 0; v < kMaxVoices; ++v) {
+      if (!(active & (1U << v)))
+        continue;
+      const dsp::AdsrQuad & env = env_[v >> 2];
+      allocator_.setLevel(v, env.level(v & 3));
+      if (allocator_.isReleased(v) && !env.isActive(v & 3))
+        allocator_.free(v);
+    }
+  }
+
+  /**
+   * Apply an event posted by a callback, render side.
+   */
+  inline void applyEvent(const utils::UnitEvent & event) {
+    switch (event.type) {
+      case utils::k_unit_event_param:
+        applyParameter(event.index, event.value);
+        break;
+      case utils::k_unit_event_tempo:
+        // Note: 16.16 fixed point bpm
+        tempo_ = (static_cast<uint32_t>(event.value) >> 16) + (event.value & 0xFFFF) / static_cast<float>(0x10000);
+        break;
+      case utils::k_unit_event_note_on:
+        noteOn(event.index, event.value);
+        break;
+      case utils::k_unit_event_note_off:
+        noteOff(event.index);
+        break;
+      case utils::k_unit_event_gate_on:
+        noteOn(kGateNote, event.value);
+        break;
+      case utils::k_unit_event_gate_off:
+        noteOff(kGateNote);
+        break;
+      case utils::k_unit_event_all_note_off:
+        allNoteOff();
+        break;
+      case utils::k_unit_event_pitch_bend:
+        pitchBend(event.value);
+        break;
+      default:
+        break;
+    }
+  }
+
+  inline void applyParameter(uint8_t index, int32_t value) {
+    const float v = value * 0.01f;
+    switch (index) {
+      case ATTACK:
+        // Note: exponential mapping from 1ms to 2s
+        for (size_t g = 0; g < kNumGroups; ++g)
+          env_[g].setAttack(0.001f * powf(2000.f, v));
+        break;
+      case DECAY:
+        // Note: exponential mapping from 5ms to 5s
+        for (size_t g = 0; g < kNumGroups; ++g)
+          env_[g].setDecay(0.005f * powf(1000.f, v));
+        break;
+      case SUSTAIN:
+        for (size_t g = 0; g < kNumGroups; ++g)
+          env_[g].setSustain(v);
+        break;
+      case RELEASE:
+        // Note: exponential mapping from 5ms to 5s
+        for (size_t g = 0; g < kNumGroups; ++g)
+          env_[g].setRelease(0.005f * powf(1000.f, v));
+        break;
+      case CUTOFF:
+        smoother_.setValue(index, value);
+        break;
+      case VOICES:
+        allocator_.setPolyphony(value);
+        releaseGates();
+        break;
+      case STEAL:
+        allocator_.setPolicy(static_cast<dsp::VoiceStealPolicy>(value));
+        break;
+      default:
+        break;
+    }
+  }
+
+  inline void noteOn(uint8_t note, uint8_t velocity) {
+    // Note: envelope continues from the current level of the voice, so retriggered or stolen voices do not click
+    const uint8_t v = allocator_.noteOn(note);
+    inc_[v] = 440.f * powf(2.f, (note - 69.f) * (1.f / 12.f)) / kSampleRate;
+    amp_[v] = kVoiceGain * velocity * (1.f / 127.f);
+    env_[v >> 2].gateOn(v & 3);
+  }
+
+  inline void noteOff(uint8_t note) {
+    const uint8_t v = allocator_.noteOff(note);
+    if (v != allocator_.kNoVoice)
+      env_[v >> 2].gateOff(v & 3);
+  }
+
+  inline void allNoteOff() {
+    allocator_.releaseAll();
+    releaseGates();
+  }
+
+  inline void pitchBend(uint16_t bend) {
+    // Note: 14 bit value centered at 0x2000, +/-2 semitones
+    bend_ = powf(2.f, (static_cast<int32_t>(bend) - 0x2000) * (2.f / (12.f * 0x2000)));
+  }
+
+  inline void updateCutoff() {
+    // Note: one pole lowpass, exponential mapping from 50Hz to 16kHz
+    const float v = smoother_.getValue(CUTOFF) * 0.01f;
+    cutoff_coef_ = 1.f - expf(-2.f * M_PI * 50.f * powf(320.f, v) / kSampleRate);
+  }
+
+  inline void releaseGates() {
+    for (uint8_t v = 0; v < kMaxVoices; ++v) {
+      if (!allocator_.isHeld(v))
+        env_[v >> 2].gateOff(v & 3);
+    }
+  }
 };
@@ -0,0 +1,57 @@
+/**
+ *  @file bench.cc
+ *  @brief Per-callback timing statistics for the host runner benchmark mode
+ *
+ *  Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include "bench.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+uint64_t RenderBenchmark::Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+RenderBenchmark::Stats RenderBenchmark::Compute() const {
+  Stats s = {};
+  s.calls = samples_ns_.size();
+  s.deadline_ns = 1e9 * frames_per_buffer_ / samplerate_;
+  if (samples_ns_.empty())
+    return s;
+
+  std::vector<uint64_t> sorted(samples_ns_);
+  std::sort(sorted.begin(), sorted.end());
+
+  double total = 0;
+  for (uint64_t ns : sorted)
+    total += ns;
+
+  // Nearest-rank percentiles, the ceil(p * n)-th smallest sample
+  const auto rank = [&](double p) {
+    size_t r = (size_t)std::ceil(p * sorted.size());
+    r = std::max<size_t>(1, std::min(r, sorted.size()));
+    return (double)sorted[r - 1];
+  };
+
+  s.ns_per_frame = total / ((double)sorted.size() * frames_per_buffer_);
+  s.p50_ns = rank(0.5);
+  s.p99_ns = rank(0.99);
+  s.max_ns = (double)sorted.back();
+  return s;
+}
+
+void RenderBenchmark::Print(const std::string & label, uint32_t frames_per_buffer, const Stats & s) {
+  const double d = s.deadline_ns;
+  std::printf("%-20s frames: %3u calls: %7zu  ns/frame: %8.2f  p50: %9.0f ns  p99: %9.0f ns  max: %9.0f ns"
+              "  deadline: %7.0f ns  load p50: %6.3f%%  p99: %6.3f%%  max: %6.3f%%\n",
+              label.c_str(), frames_per_buffer, s.calls, s.ns_per_frame, s.p50_ns, s.p99_ns, s.max_ns, d,
+              100. * s.p50_ns / d, 100. * s.p99_ns / d, 100. * s.max_ns / d);
+}
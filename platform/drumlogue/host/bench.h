@@ -0,0 +1,61 @@
+#pragma once
+/*
+ *  File: bench.h
+ *
+ *  Per-callback timing statistics for the host runner benchmark mode.
+ *
+ *  2020-2022 (c) Korg
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class RenderBenchmark {
+ public:
+  /*===========================================================================*/
+  /* Public Data Structures/Types. */
+  /*===========================================================================*/
+
+  struct Stats {
+    size_t calls;
+    double ns_per_frame;  // mean over all measured calls
+    double p50_ns;        // per render call
+    double p99_ns;
+    double max_ns;
+    double deadline_ns;   // duration of one buffer of audio
+  };
+
+  /*===========================================================================*/
+  /* Lifecycle Methods. */
+  /*===========================================================================*/
+
+  RenderBenchmark(uint32_t samplerate, uint32_t frames_per_buffer, size_t calls)
+      : samplerate_(samplerate), frames_per_buffer_(frames_per_buffer) {
+    samples_ns_.reserve(calls);
+  }
+
+  /*===========================================================================*/
+  /* Other Public Methods. */
+  /*===========================================================================*/
+
+  static uint64_t Now();
+
+  inline void Record(uint64_t start_ns, uint64_t end_ns) { samples_ns_.push_back(end_ns - start_ns); }
+
+  Stats Compute() const;
+
+  // Note: single line, stable format so results can be diffed/grepped across revisions
+  static void Print(const std::string & label, uint32_t frames_per_buffer, const Stats & stats);
+
+ private:
+  /*===========================================================================*/
+  /* Private Member Variables. */
+  /*===========================================================================*/
+
+  uint32_t samplerate_;
+  uint32_t frames_per_buffer_;
+  std::vector<uint64_t> samples_ns_;
+};
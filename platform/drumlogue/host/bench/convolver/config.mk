@@ -0,0 +1,50 @@
+##############################################################################
+# Configuration for Makefile
+#
+# Host benchmark of dsp/convolver.hpp with a long stereo impulse response,
+# see bench-convolver in ../../Makefile
+#
+
+PROJECT := bench_convolver
+PROJECT_TYPE := revfx
+
+##############################################################################
+# Sources
+#
+
+# C sources
+CSRC = header.c
+
+# C++ sources
+CXXSRC = unit.cc
+
+# List ASM source files here
+ASMSRC = 
+
+ASMXSRC = 
+
+##############################################################################
+# Include Paths
+#
+
+UINCDIR  = 
+
+##############################################################################
+# Library Paths
+#
+
+ULIBDIR = 
+
+##############################################################################
+# Libraries
+#
+
+ULIBS  = -lm
+ULIBS += -lc
+
+##############################################################################
+# Macros
+#
+
+UDEFS = 
+
@@ -0,0 +1,24 @@
+/**
+ *  @file header.c
+ *  @brief drumlogue SDK unit header
+ *
+ *  Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include "unit.h"  // Note: Include common definitions for all units
+
+// ---- Unit header definition  --------------------------------------------------------------------
+
+// Note: no parameters, the impulse response is fixed, see unit.cc
+const __unit_header unit_header_t unit_header = {
+    .header_size = sizeof(unit_header_t),                  // leave as is, size of this header
+    .target = UNIT_TARGET_PLATFORM | k_unit_module_revfx,  // target platform and module for this unit
+    .api = UNIT_API_VERSION,                               // logue sdk API version against which unit was built
+    .dev_id = 0x0U,                                        // developer id
+    .unit_id = 0x0U,                                       // Id for this unit, should be unique within the scope of a given dev_id
+    .version = 0x00010000U,                                // This unit's version: major.minor.patch (major<<16 minor<<8 patch).
+    .name = "convolver",                                   // Name for this unit, will be displayed on device
+    .num_presets = 0,                                      // Number of internal presets this unit has
+    .num_params = 0,                                       // Number of parameters for this unit, max 24
+    .params = {{0, 0, 0, 0, k_unit_param_type_none, 0, 0, 0, {""}}}};
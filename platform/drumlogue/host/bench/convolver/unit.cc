@@ -0,0 +1,63 @@
+/*
+ *  File: unit.cc
+ *
+ *  @brief Convolution reverb benchmark unit, dsp::Convolver with a long stereo impulse response
+ *
+ *  2022 (c) Korg All rights reserved.
+ *
+ */
+
+#include <cmath>
+
+#include "unit.h"  // Note: Include common definitions for all units
+#include "dsp/convolver.hpp"
+
+typedef dsp::Convolver<128> Convolver;
+
+// Note: 2 seconds at 48 kHz, per channel
+static constexpr size_t kIrFrames = 96000;
+
+static Convolver s_convolver[2];
+static float s_ir[kIrFrames];
+static float s_ram[2][Convolver::memorySize(kIrFrames)] __attribute__((aligned(16)));
+
+// ---- Callback entry points from drumlogue runtime ----------------------------------------------
+
+__unit_callback int8_t unit_init(const unit_runtime_desc_t * desc) {
+  if (!desc)
+    return k_unit_err_undef;
+
+  // Note: make sure the unit is being loaded to the correct platform/module target
+  if (desc->target != unit_header.target)
+    return k_unit_err_target;
+
+  // Note: check API compatibility with the one this unit was built against
+  if (!UNIT_API_IS_COMPAT(desc->api))
+    return k_unit_err_api_version;
+
+  if (desc->input_channels != 2 || desc->output_channels != 2)
+    return k_unit_err_geometry;
+
+  // Note: exponentially decaying noise, -60 dB at the end, a different one per channel
+  uint32_t seed = 0x2545F491U;
+  for (size_t ch = 0; ch < 2; ++ch) {
+    for (size_t i = 0; i < kIrFrames; ++i) {
+      seed = seed * 1664525U + 1013904223U;
+      s_ir[i] = (int32_t)seed * (1.f / 2147483648.f) * expf(-6.9f * i / kIrFrames);
+    }
+    s_convolver[ch].init(s_ram[ch], kIrFrames);
+    s_convolver[ch].setImpulseResponse(s_ir, kIrFrames);
+  }
+
+  return k_unit_err_none;
+}
+
+__unit_callback void unit_reset() {
+  s_convolver[0].reset();
+  s_convolver[1].reset();
+}
+
+__unit_callback void unit_render(const float * in, float * out, uint32_t frames) {
+  s_convolver[0].process(in, out, frames, 2);
+  s_convolver[1].process(in + 1, out + 1, frames, 2);
+}
@@ -0,0 +1,172 @@
+/**
+ * @file arm_neon.h
+ * @brief Minimal host stand-in for the NEON intrinsics header
+ *
+ * Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+// Note: Only used when building units for the host runner. Provides the subset of float NEON
+//       intrinsics used by the template units, implemented with GCC vector extensions.
+//       __ARM_NEON is intentionally left undefined so that SDK headers pick their scalar paths,
+//       their NEON paths can be checked on the host by defining it explicitly.
+
+#ifndef HOST_ARM_NEON_H_
+#define HOST_ARM_NEON_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef float float32x2_t __attribute__((vector_size(8)));
+typedef float float32x4_t __attribute__((vector_size(16)));
+typedef int32_t int32x2_t __attribute__((vector_size(8)));
+typedef int32_t int32x4_t __attribute__((vector_size(16)));
+typedef uint32_t uint32x2_t __attribute__((vector_size(8)));
+typedef uint32_t uint32x4_t __attribute__((vector_size(16)));
+
+typedef struct {
+  float32x4_t val[2];
+} float32x4x2_t;
+
+typedef struct {
+  float32x4_t val[4];
+} float32x4x4_t;
+
+#define __host_neon_inline static inline __attribute__((always_inline))
+
+// ---- Loads / stores -----------------------------------------------------------------------------
+
+__host_neon_inline float32x2_t vld1_f32(const float * p) {
+  float32x2_t v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+__host_neon_inline float32x4_t vld1q_f32(const float * p) {
+  float32x4_t v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+__host_neon_inline float32x4_t vld1q_dup_f32(const float * p) { return (float32x4_t){*p, *p, *p, *p}; }
+
+__host_neon_inline int32x4_t vld1q_s32(const int32_t * p) {
+  int32x4_t v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+__host_neon_inline uint32x4_t vld1q_u32(const uint32_t * p) {
+  uint32x4_t v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+__host_neon_inline void vst1_f32(float * p, float32x2_t v) { __builtin_memcpy(p, &v, sizeof(v)); }
+
+__host_neon_inline void vst1q_f32(float * p, float32x4_t v) { __builtin_memcpy(p, &v, sizeof(v)); }
+
+// Note: deinterleaving load, p[2 * n] goes to lane n of val[0] and p[2 * n + 1] to lane n of val[1]
+__host_neon_inline float32x4x2_t vld2q_f32(const float * p) {
+  float32x4x2_t v;
+  for (int n = 0; n < 4; ++n)
+    for (int k = 0; k < 2; ++k) v.val[k][n] = p[2 * n + k];
+  return v;
+}
+
+__host_neon_inline void vst2q_f32(float * p, float32x4x2_t v) {
+  for (int n = 0; n < 4; ++n)
+    for (int k = 0; k < 2; ++k) p[2 * n + k] = v.val[k][n];
+}
+
+// Note: lane n of the four vectors is stored at p[4 * n] to p[4 * n + 3]
+__host_neon_inline void vst4q_f32(float * p, float32x4x4_t v) {
+  for (int n = 0; n < 4; ++n)
+    for (int k = 0; k < 4; ++k) p[4 * n + k] = v.val[k][n];
+}
+
+// ---- Lane access / construction -----------------------------------------------------------------
+
+__host_neon_inline float32x2_t vdup_n_f32(float s) { return (float32x2_t){s, s}; }
+
+__host_neon_inline float32x4_t vdupq_n_f32(float s) { return (float32x4_t){s, s, s, s}; }
+
+__host_neon_inline float32x2_t vget_low_f32(float32x4_t v) { return (float32x2_t){v[0], v[1]}; }
+
+__host_neon_inline float32x2_t vget_high_f32(float32x4_t v) { return (float32x2_t){v[2], v[3]}; }
+
+__host_neon_inline float32x4_t vcombine_f32(float32x2_t l, float32x2_t h) {
+  return (float32x4_t){l[0], l[1], h[0], h[1]};
+}
+
+__host_neon_inline int32x4_t vdupq_n_s32(int32_t s) { return (int32x4_t){s, s, s, s}; }
+
+#define vget_lane_f32(v, l) ((v)[(l)])
+#define vgetq_lane_f32(v, l) ((v)[(l)])
+
+// Note: lanes n to 3 of a followed by lanes 0 to n-1 of b
+__host_neon_inline float32x4_t vextq_f32(float32x4_t a, float32x4_t b, const int n) {
+  return __builtin_shuffle(a, b, (int32x4_t){n, n + 1, n + 2, n + 3});
+}
+
+__host_neon_inline float32x2_t vrev64_f32(float32x2_t v) { return (float32x2_t){v[1], v[0]}; }
+
+__host_neon_inline float32x4_t vrev64q_f32(float32x4_t v) {
+  return __builtin_shuffle(v, (int32x4_t){1, 0, 3, 2});
+}
+
+// ---- Arithmetic ---------------------------------------------------------------------------------
+
+__host_neon_inline float32x2_t vadd_f32(float32x2_t a, float32x2_t b) { return a + b; }
+__host_neon_inline float32x4_t vaddq_f32(float32x4_t a, float32x4_t b) { return a + b; }
+__host_neon_inline float32x2_t vsub_f32(float32x2_t a, float32x2_t b) { return a - b; }
+__host_neon_inline float32x4_t vsubq_f32(float32x4_t a, float32x4_t b) { return a - b; }
+__host_neon_inline float32x2_t vmul_f32(float32x2_t a, float32x2_t b) { return a * b; }
+__host_neon_inline float32x4_t vmulq_f32(float32x4_t a, float32x4_t b) { return a * b; }
+__host_neon_inline float32x2_t vmul_n_f32(float32x2_t a, float s) { return a * s; }
+__host_neon_inline float32x4_t vmulq_n_f32(float32x4_t a, float s) { return a * s; }
+__host_neon_inline float32x2_t vmla_f32(float32x2_t a, float32x2_t b, float32x2_t c) { return a + b * c; }
+__host_neon_inline float32x4_t vmlaq_f32(float32x4_t a, float32x4_t b, float32x4_t c) { return a + b * c; }
+__host_neon_inline float32x2_t vmla_n_f32(float32x2_t a, float32x2_t b, float s) { return a + b * s; }
+__host_neon_inline float32x4_t vmlaq_n_f32(float32x4_t a, float32x4_t b, float s) { return a + b * s; }
+__host_neon_inline float32x2_t vmls_f32(float32x2_t a, float32x2_t b, float32x2_t c) { return a - b * c; }
+__host_neon_inline float32x4_t vmlsq_f32(float32x4_t a, float32x4_t b, float32x4_t c) { return a - b * c; }
+__host_neon_inline float32x4_t vnegq_f32(float32x4_t a) { return -a; }
+
+// Note: the estimate is exact here, Newton-Raphson steps with vrecpsq_f32 leave it unchanged
+__host_neon_inline float32x4_t vrecpeq_f32(float32x4_t a) { return 1.f / a; }
+__host_neon_inline float32x4_t vrecpsq_f32(float32x4_t a, float32x4_t b) { return 2.f - a * b; }
+
+// Note: pairwise add, lanes a0+a1, b0+b1
+__host_neon_inline float32x2_t vpadd_f32(float32x2_t a, float32x2_t b) { return (float32x2_t){a[0] + a[1], b[0] + b[1]}; }
+
+__host_neon_inline float32x4_t vminq_f32(float32x4_t a, float32x4_t b) {
+  return (float32x4_t){a[0] < b[0] ? a[0] : b[0], a[1] < b[1] ? a[1] : b[1], a[2] < b[2] ? a[2] : b[2],
+                       a[3] < b[3] ? a[3] : b[3]};
+}
+
+__host_neon_inline int32x4_t vsubq_s32(int32x4_t a, int32x4_t b) { return a - b; }
+
+// ---- Comparison / selection ---------------------------------------------------------------------
+
+__host_neon_inline uint32x4_t vcgeq_f32(float32x4_t a, float32x4_t b) { return (uint32x4_t)(a >= b); }
+__host_neon_inline uint32x4_t vcgtq_f32(float32x4_t a, float32x4_t b) { return (uint32x4_t)(a > b); }
+__host_neon_inline uint32x4_t vcltq_f32(float32x4_t a, float32x4_t b) { return (uint32x4_t)(a < b); }
+__host_neon_inline uint32x4_t vcgeq_s32(int32x4_t a, int32x4_t b) { return (uint32x4_t)(a >= b); }
+__host_neon_inline uint32x4_t vcltq_s32(int32x4_t a, int32x4_t b) { return (uint32x4_t)(a < b); }
+__host_neon_inline uint32x4_t vandq_u32(uint32x4_t a, uint32x4_t b) { return a & b; }
+
+__host_neon_inline float32x4_t vbslq_f32(uint32x4_t m, float32x4_t a, float32x4_t b) {
+  return (float32x4_t)((m & (uint32x4_t)a) | (~m & (uint32x4_t)b));
+}
+
+#undef __host_neon_inline
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // HOST_ARM_NEON_H_
@@ -0,0 +1,433 @@
+/**
+ *  @file runner.cc
+ *  @brief Offline host runner for drumlogue units
+ *
+ *  Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "runtime.h"
+#include "unit_loader.h"
+#include "wav_file.h"
+
+namespace {
+
+  /*===========================================================================*/
+  /* Emulated Sample Banks. */
+  /*===========================================================================*/
+
+  // Note: the device exposes up to 128 samples per bank; the runner fills banks from WAV files.
+  constexpr size_t k_max_banks = 8;
+  constexpr size_t k_max_samples_per_bank = 128;
+
+  struct SampleSlot {
+    sample_wrapper_t wrapper;
+    std::vector<float> data;
+  };
+
+  std::vector<SampleSlot> s_banks[k_max_banks];
+
+  uint8_t GetNumSampleBanks() {
+    uint8_t n = 0;
+    for (size_t i = 0; i < k_max_banks; ++i)
+      if (!s_banks[i].empty())
+        n = i + 1;
+    return n;
+  }
+
+  uint8_t GetNumSamplesForBank(uint8_t bank) {
+    return (bank < k_max_banks) ? s_banks[bank].size() : 0;
+  }
+
+  const sample_wrapper_t * GetSample(uint8_t bank, uint8_t index) {
+    if (bank >= k_max_banks || index >= s_banks[bank].size())
+      return nullptr;
+    return &s_banks[bank][index].wrapper;
+  }
+
+  bool AddSample(const std::string & spec, std::string * error) {
+    // Format: [bank:]path
+    size_t bank = 0;
+    std::string path = spec;
+    const size_t colon = spec.find(':');
+    if (colon != std::string::npos && colon > 0 && spec.find_first_not_of("0123456789") == colon) {
+      bank = std::strtoul(spec.c_str(), nullptr, 10);
+      path = spec.substr(colon + 1);
+    }
+    if (bank >= k_max_banks || s_banks[bank].size() >= k_max_samples_per_bank) {
+      *error = "sample bank full or out of range: " + spec;
+      return false;
+    }
+
+    WavFile wav;
+    if (!wav.Read(path, error))
+      return false;
+
+    s_banks[bank].emplace_back();
+    SampleSlot & slot = s_banks[bank].back();
+    slot.data = std::move(wav.samples);
+
+    sample_wrapper_t & w = slot.wrapper;
+    std::memset(&w, 0, sizeof(w));
+    w.bank = bank;
+    w.index = s_banks[bank].size() - 1;
+    w.channels = wav.channels;
+    const size_t slash = path.find_last_of('/');
+    std::strncpy(w.name, path.c_str() + ((slash == std::string::npos) ? 0 : slash + 1),
+                 UNIT_SAMPLE_WRAPPER_MAX_NAME_LEN);
+    w.frames = wav.frames;
+    return true;
+  }
+
+  void FixupSamplePointers() {
+    // Note: vectors may have been reallocated while loading, resolve pointers once all are loaded
+    for (size_t b = 0; b < k_max_banks; ++b)
+      for (SampleSlot & slot : s_banks[b])
+        slot.wrapper.sample_ptr = slot.data.data();
+  }
+
+  /*===========================================================================*/
+  /* Options. */
+  /*===========================================================================*/
+
+  struct ParamSetting {
+    uint8_t id;
+    int32_t value;
+  };
+
+  struct NoteSetting {
+    uint8_t note;
+    uint8_t velocity;
+  };
+
+  struct Options {
+    std::string unit_path;
+    std::string input_path;
+    std::string output_path;
+    uint16_t frames_per_buffer = 64;
+    int input_channels = -1;
+    int output_channels = -1;
+    float duration = 2.f;
+    float tail = 0.f;
+    float gate = 1.f;
+    float tempo = 120.f;
+    int preset = -1;
+    uint16_t output_bits = 32;
+    bool verbose = false;
+    size_t bench_calls = 0;
+    std::string bench_label;
+    std::vector<ParamSetting> params;
+    std::vector<NoteSetting> notes;
+  };
+
+  void Usage(const char * argv0) {
+    std::fprintf(stderr,
+                 "Usage: %s [options] <unit.so>\n"
+                 "\n"
+                 "  -i FILE        Input WAV file (effects)\n"
+                 "  -o FILE        Output WAV file\n"
+                 "  -b BITS        Output bit depth: 16 or 32 (float, default)\n"
+                 "  -f FRAMES      Frames per buffer (default: 64)\n"
+                 "  -c IN:OUT      Override input/output channel counts\n"
+                 "  -d SECONDS     Render duration when no input is given (default: 2)\n"
+                 "  -T SECONDS     Extra tail rendered after the input ends (default: 0)\n"
+                 "  -p ID=VALUE    Set parameter after initialization (repeatable)\n"
+                 "  -P INDEX       Load preset after initialization\n"
+                 "  -n NOTE[:VEL]  Note on at start of render (repeatable, synth)\n"
+                 "  -g SECONDS     Gate length before note offs (default: 1)\n"
+                 "  -t BPM         Tempo (default: 120)\n"
+                 "  -s [BANK:]FILE Load WAV file into an emulated sample bank (repeatable)\n"
+                 "  -v             Print unit header and parameter values\n"
+                 "  -B CALLS       Benchmark mode: time CALLS render calls, no WAV output\n"
+                 "  -L LABEL       Label printed with benchmark results (default: unit name)\n",
+                 argv0);
+  }
+
+  bool ParseOptions(int argc, char ** argv, Options * o) {
+    int c;
+    std::string error;
+    while ((c = getopt(argc, argv, "i:o:b:f:c:d:T:p:P:n:g:t:s:vB:L:h")) != -1) {
+      switch (c) {
+        case 'i':
+          o->input_path = optarg;
+          break;
+        case 'o':
+          o->output_path = optarg;
+          break;
+        case 'b':
+          o->output_bits = std::atoi(optarg);
+          break;
+        case 'f':
+          o->frames_per_buffer = std::atoi(optarg);
+          break;
+        case 'c':
+          if (std::sscanf(optarg, "%d:%d", &o->input_channels, &o->output_channels) != 2)
+            return false;
+          break;
+        case 'd':
+          o->duration = std::atof(optarg);
+          break;
+        case 'T':
+          o->tail = std::atof(optarg);
+          break;
+        case 'p': {
+          int id, value;
+          if (std::sscanf(optarg, "%d=%d", &id, &value) != 2 || id < 0 || id >= UNIT_MAX_PARAM_COUNT)
+            return false;
+          o->params.push_back({(uint8_t)id, value});
+        } break;
+        case 'P':
+          o->preset = std::atoi(optarg);
+          break;
+        case 'n': {
+          int note, velocity = 100;
+          if (std::sscanf(optarg, "%d:%d", &note, &velocity) < 1)
+            return false;
+          o->notes.push_back({(uint8_t)(note & 0x7F), (uint8_t)(velocity & 0x7F)});
+        } break;
+        case 'g':
+          o->gate = std::atof(optarg);
+          break;
+        case 't':
+          o->tempo = std::atof(optarg);
+          break;
+        case 's':
+          if (!AddSample(optarg, &error)) {
+            std::fprintf(stderr, "error: %s\n", error.c_str());
+            std::exit(EXIT_FAILURE);
+          }
+          break;
+        case 'v':
+          o->verbose = true;
+          break;
+        case 'B':
+          o->bench_calls = std::strtoul(optarg, nullptr, 10);
+          break;
+        case 'L':
+          o->bench_label = optarg;
+          break;
+        default:
+          return false;
+      }
+    }
+    if (optind != argc - 1)
+      return false;
+    o->unit_path = argv[optind];
+    return o->frames_per_buffer > 0 && (o->output_bits == 16 || o->output_bits == 32);
+  }
+
+  void PrintHeader(const unit_header_t & h, const UnitLoader::Callbacks & cb) {
+    std::printf("unit: \"%s\" module: %s dev_id: 0x%08X unit_id: 0x%08X version: %u.%u.%u api: %u.%u.%u\n",
+                h.name, UnitLoader::ModuleName(h.target & UNIT_TARGET_MODULE_MASK), h.dev_id, h.unit_id,
+                UNIT_API_MAJOR(h.version), UNIT_API_MINOR(h.version), UNIT_API_PATCH(h.version),
+                UNIT_API_MAJOR(h.api), UNIT_API_MINOR(h.api), UNIT_API_PATCH(h.api));
+    for (uint32_t i = 0; i < h.num_params && i < UNIT_MAX_PARAM_COUNT; ++i) {
+      const unit_param_t & p = h.params[i];
+      if (p.name[0] == '\0')
+        continue;
+      const int32_t value = cb.get_param_value(i);
+      const char * str = (p.type == k_unit_param_type_strings) ? cb.get_param_str_value(i, value) : nullptr;
+      std::printf("  param %2u %-12s [%d, %d] init: %d value: %d%s%s\n", i, p.name, p.min, p.max, p.init,
+                  value, str ? " " : "", str ? str : "");
+    }
+  }
+
+  /*===========================================================================*/
+  /* Benchmark Mode. */
+  /*===========================================================================*/
+
+  void RunBenchmark(const Options & opt, const unit_runtime_desc_t & desc, const UnitLoader & unit) {
+    const UnitLoader::Callbacks & cb = unit.callbacks();
+    const uint32_t frames = desc.frames_per_buffer;
+
+    // Note: effects are fed deterministic white noise so that processing is never trivially silent
+    std::vector<float> in_buf((size_t)frames * desc.input_channels);
+    std::vector<float> out_buf((size_t)frames * desc.output_channels);
+    uint32_t seed = 0x12345678U;
+    const auto refill = [&]() {
+      for (float & s : in_buf) {
+        seed = seed * 1664525U + 1013904223U;
+        s = (int32_t)seed * (0.5f / 2147483648.f);
+      }
+    };
+
+    cb.resume();
+    for (const NoteSetting & n : opt.notes)
+      cb.note_on(n.note, n.velocity);
+
+    // Warm up caches, branch predictors and lazily initialized unit state
+    const size_t warmup = std::max<size_t>(opt.bench_calls / 10, 16);
+    for (size_t i = 0; i < warmup; ++i) {
+      refill();
+      cb.render(in_buf.data(), out_buf.data(), frames);
+    }
+
+    RenderBenchmark bench(desc.samplerate, frames, opt.bench_calls);
+    for (size_t i = 0; i < opt.bench_calls; ++i) {
+      refill();
+      const uint64_t t0 = RenderBenchmark::Now();
+      cb.render(in_buf.data(), out_buf.data(), frames);
+      const uint64_t t1 = RenderBenchmark::Now();
+      bench.Record(t0, t1);
+    }
+
+    cb.all_note_off();
+    cb.suspend();
+    cb.teardown();
+
+    const std::string label = opt.bench_label.empty() ? std::string(unit.header().name) : opt.bench_label;
+    RenderBenchmark::Print(label, frames, bench.Compute());
+  }
+
+}  // namespace
+
+int main(int argc, char ** argv) {
+  Options opt;
+  if (!ParseOptions(argc, argv, &opt)) {
+    Usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  FixupSamplePointers();
+
+  std::string error;
+  UnitLoader unit;
+  if (!unit.Load(opt.unit_path, &error)) {
+    std::fprintf(stderr, "error: %s\n", error.c_str());
+    return EXIT_FAILURE;
+  }
+  const unit_header_t & header = unit.header();
+  const UnitLoader::Callbacks & cb = unit.callbacks();
+
+  // Default buffer geometry per module, as provided by the drumlogue runtime
+  const uint8_t module = unit.module();
+  const uint8_t in_ch = (opt.input_channels >= 0) ? opt.input_channels
+                                                  : (module == k_unit_module_masterfx) ? 4 : 2;
+  const uint8_t out_ch = (opt.output_channels >= 0) ? opt.output_channels : 2;
+
+  unit_runtime_desc_t desc;
+  desc.target = header.target;
+  desc.api = UNIT_API_VERSION;
+  desc.samplerate = 48000;
+  desc.frames_per_buffer = opt.frames_per_buffer;
+  desc.input_channels = in_ch;
+  desc.output_channels = out_ch;
+  desc.get_num_sample_banks = GetNumSampleBanks;
+  desc.get_num_samples_for_bank = GetNumSamplesForBank;
+  desc.get_sample = GetSample;
+
+  const int8_t err = cb.init(&desc);
+  if (err != k_unit_err_none) {
+    std::fprintf(stderr, "error: unit_init returned %d\n", err);
+    return EXIT_FAILURE;
+  }
+
+  // Mirror the runtime: parameters are set to their declared init values after initialization
+  for (uint32_t i = 0; i < header.num_params && i < UNIT_MAX_PARAM_COUNT; ++i)
+    if (header.params[i].name[0] != '\0')
+      cb.set_param_value(i, header.params[i].init);
+  if (opt.preset >= 0)
+    cb.load_preset(opt.preset);
+  for (const ParamSetting & p : opt.params)
+    cb.set_param_value(p.id, p.value);
+  cb.set_tempo((uint32_t)(opt.tempo * 0x10000));
+
+  if (opt.verbose)
+    PrintHeader(header, cb);
+
+  if (opt.bench_calls > 0) {
+    RunBenchmark(opt, desc, unit);
+    return EXIT_SUCCESS;
+  }
+
+  // Input signal, mapped onto the unit's input channel layout
+  WavFile input;
+  size_t input_frames = 0;
+  if (!opt.input_path.empty()) {
+    if (!input.Read(opt.input_path, &error)) {
+      std::fprintf(stderr, "error: %s\n", error.c_str());
+      return EXIT_FAILURE;
+    }
+    if (input.samplerate != desc.samplerate)
+      std::fprintf(stderr, "warning: input samplerate %u Hz, rendering at %u Hz\n", input.samplerate,
+                   desc.samplerate);
+    input_frames = input.frames;
+  }
+
+  const size_t total_frames = opt.input_path.empty()
+                                  ? (size_t)(opt.duration * desc.samplerate)
+                                  : input_frames + (size_t)(opt.tail * desc.samplerate);
+  const size_t gate_frames = (size_t)(opt.gate * desc.samplerate);
+
+  WavFile output;
+  output.samplerate = desc.samplerate;
+  output.channels = out_ch;
+  output.frames = total_frames;
+  output.samples.assign(total_frames * out_ch, 0.f);
+
+  std::vector<float> in_buf((size_t)opt.frames_per_buffer * in_ch);
+  std::vector<float> out_buf((size_t)opt.frames_per_buffer * out_ch);
+
+  cb.resume();
+
+  for (const NoteSetting & n : opt.notes)
+    cb.note_on(n.note, n.velocity);
+  bool gate_open = !opt.notes.empty();
+
+  for (size_t pos = 0; pos < total_frames;) {
+    if (gate_open && pos >= gate_frames) {
+      for (const NoteSetting & n : opt.notes)
+        cb.note_off(n.note);
+      gate_open = false;
+    }
+
+    size_t frames = total_frames - pos;
+    if (frames > opt.frames_per_buffer)
+      frames = opt.frames_per_buffer;
+    // Note: keep note offs sample aligned to the buffer that contains them
+    if (gate_open && pos + frames > gate_frames)
+      frames = gate_frames - pos;
+
+    for (size_t f = 0; f < frames; ++f) {
+      for (size_t ch = 0; ch < in_ch; ++ch) {
+        float s = 0.f;
+        if (pos + f < input_frames) {
+          // Note: mono inputs are duplicated, extra channels (e.g. sidechain) stay silent
+          const size_t src_ch = (input.channels == 1 && ch < 2) ? 0 : ch;
+          if (src_ch < input.channels)
+            s = input.samples[(pos + f) * input.channels + src_ch];
+        }
+        in_buf[f * in_ch + ch] = s;
+      }
+    }
+
+    cb.render(in_buf.data(), out_buf.data(), frames);
+
+    std::memcpy(&output.samples[pos * out_ch], out_buf.data(), frames * out_ch * sizeof(float));
+    pos += frames;
+  }
+
+  if (gate_open)
+    cb.all_note_off();
+
+  cb.suspend();
+  cb.teardown();
+
+  if (!opt.output_path.empty() && !output.Write(opt.output_path, opt.output_bits, &error)) {
+    std::fprintf(stderr, "error: %s\n", error.c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::printf("rendered %zu frames (%.3f s) in buffers of %u frames, %u in / %u out channels\n", total_frames,
+              (double)total_frames / desc.samplerate, opt.frames_per_buffer, in_ch, out_ch);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,102 @@
+/**
+ *  @file unit_loader.cc
+ *  @brief Loads a host-built unit shared object and resolves its entry points
+ *
+ *  Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include "unit_loader.h"
+
+#include <dlfcn.h>
+
+namespace {
+
+  template <typename T>
+  bool Resolve(void * handle, const char * sym, T * out, std::string * error) {
+    *out = reinterpret_cast<T>(dlsym(handle, sym));
+    if (!*out) {
+      *error = std::string("missing symbol: ") + sym;
+      return false;
+    }
+    return true;
+  }
+
+}  // namespace
+
+bool UnitLoader::Load(const std::string & path, std::string * error) {
+  Unload();
+
+  // Note: RTLD_LOCAL so several units could be loaded side by side without symbol clashes
+  handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!handle_) {
+    *error = dlerror();
+    return false;
+  }
+
+  header_ = static_cast<const unit_header_t *>(dlsym(handle_, "unit_header"));
+  if (!header_) {
+    *error = "missing symbol: unit_header";
+    Unload();
+    return false;
+  }
+  if (header_->header_size != sizeof(unit_header_t)) {
+    *error = "unexpected unit header size";
+    Unload();
+    return false;
+  }
+
+  // Note: all entry points have weak fallbacks in _unit_base.c, so every symbol must resolve
+  Callbacks & c = callbacks_;
+  const bool ok = Resolve(handle_, "unit_init", &c.init, error) &&
+                  Resolve(handle_, "unit_teardown", &c.teardown, error) &&
+                  Resolve(handle_, "unit_reset", &c.reset, error) &&
+                  Resolve(handle_, "unit_resume", &c.resume, error) &&
+                  Resolve(handle_, "unit_suspend", &c.suspend, error) &&
+                  Resolve(handle_, "unit_render", &c.render, error) &&
+                  Resolve(handle_, "unit_get_preset_index", &c.get_preset_index, error) &&
+                  Resolve(handle_, "unit_get_preset_name", &c.get_preset_name, error) &&
+                  Resolve(handle_, "unit_load_preset", &c.load_preset, error) &&
+                  Resolve(handle_, "unit_get_param_value", &c.get_param_value, error) &&
+                  Resolve(handle_, "unit_get_param_str_value", &c.get_param_str_value, error) &&
+                  Resolve(handle_, "unit_get_param_bmp_value", &c.get_param_bmp_value, error) &&
+                  Resolve(handle_, "unit_set_param_value", &c.set_param_value, error) &&
+                  Resolve(handle_, "unit_set_tempo", &c.set_tempo, error) &&
+                  Resolve(handle_, "unit_note_on", &c.note_on, error) &&
+                  Resolve(handle_, "unit_note_off", &c.note_off, error) &&
+                  Resolve(handle_, "unit_gate_on", &c.gate_on, error) &&
+                  Resolve(handle_, "unit_gate_off", &c.gate_off, error) &&
+                  Resolve(handle_, "unit_all_note_off", &c.all_note_off, error) &&
+                  Resolve(handle_, "unit_pitch_bend", &c.pitch_bend, error) &&
+                  Resolve(handle_, "unit_channel_pressure", &c.channel_pressure, error) &&
+                  Resolve(handle_, "unit_aftertouch", &c.aftertouch, error);
+  if (!ok) {
+    Unload();
+    return false;
+  }
+  return true;
+}
+
+void UnitLoader::Unload() {
+  if (handle_)
+    dlclose(handle_);
+  handle_ = nullptr;
+  header_ = nullptr;
+  callbacks_ = {};
+}
+
+const char * UnitLoader::ModuleName(uint8_t module) {
+  switch (module) {
+    case k_unit_module_synth:
+      return "synth";
+    case k_unit_module_delfx:
+      return "delfx";
+    case k_unit_module_revfx:
+      return "revfx";
+    case k_unit_module_masterfx:
+      return "masterfx";
+    default:
+      break;
+  }
+  return "unknown";
+}
@@ -0,0 +1,79 @@
+#pragma once
+/*
+ *  File: unit_loader.h
+ *
+ *  Loads a host-built unit shared object and resolves its entry points.
+ *
+ *  2020-2022 (c) Korg
+ *
+ */
+
+#include <string>
+
+#include "runtime.h"
+
+class UnitLoader {
+ public:
+  /*===========================================================================*/
+  /* Public Data Structures/Types. */
+  /*===========================================================================*/
+
+  // Note: mirrors the callback table the drumlogue runtime resolves when loading a unit
+  struct Callbacks {
+    unit_init_func init;
+    unit_teardown_func teardown;
+    unit_reset_func reset;
+    unit_resume_func resume;
+    unit_suspend_func suspend;
+    unit_render_func render;
+    unit_get_preset_index_func get_preset_index;
+    unit_get_preset_name_func get_preset_name;
+    unit_load_preset_func load_preset;
+    unit_get_param_value_func get_param_value;
+    unit_get_param_str_value_func get_param_str_value;
+    unit_get_param_bmp_value_func get_param_bmp_value;
+    unit_set_param_value_func set_param_value;
+    unit_set_tempo_func set_tempo;
+    unit_note_on_func note_on;
+    unit_note_off_func note_off;
+    unit_gate_on_func gate_on;
+    unit_gate_off_func gate_off;
+    unit_all_note_off_func all_note_off;
+    unit_pitch_bend_func pitch_bend;
+    unit_channel_pressure_func channel_pressure;
+    unit_aftertouch_func aftertouch;
+  };
+
+  /*===========================================================================*/
+  /* Lifecycle Methods. */
+  /*===========================================================================*/
+
+  UnitLoader(void) {}
+  ~UnitLoader(void) { Unload(); }
+
+  UnitLoader(const UnitLoader &) = delete;
+  UnitLoader & operator=(const UnitLoader &) = delete;
+
+  bool Load(const std::string & path, std::string * error);
+  void Unload();
+
+  /*===========================================================================*/
+  /* Other Public Methods. */
+  /*===========================================================================*/
+
+  inline const unit_header_t & header() const { return *header_; }
+  inline const Callbacks & callbacks() const { return callbacks_; }
+
+  inline uint8_t module() const { return header_->target & UNIT_TARGET_MODULE_MASK; }
+
+  static const char * ModuleName(uint8_t module);
+
+ private:
+  /*===========================================================================*/
+  /* Private Member Variables. */
+  /*===========================================================================*/
+
+  void * handle_ = nullptr;
+  const unit_header_t * header_ = nullptr;
+  Callbacks callbacks_ = {};
+};
@@ -0,0 +1,156 @@
+/**
+ *  @file wav_file.cc
+ *  @brief Minimal RIFF/WAVE reader and writer for the host runner
+ *
+ *  Copyright (c) 2020-2022 KORG Inc. All rights reserved.
+ *
+ */
+
+#include "wav_file.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+  uint16_t ReadU16(const uint8_t * p) { return p[0] | (p[1] << 8); }
+
+  uint32_t ReadU32(const uint8_t * p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+  }
+
+  void PutU16(std::vector<uint8_t> & v, uint16_t x) {
+    v.push_back(x & 0xFF);
+    v.push_back(x >> 8);
+  }
+
+  void PutU32(std::vector<uint8_t> & v, uint32_t x) {
+    for (int i = 0; i < 4; ++i)
+      v.push_back((x >> (8 * i)) & 0xFF);
+  }
+
+  void PutTag(std::vector<uint8_t> & v, const char * tag) { v.insert(v.end(), tag, tag + 4); }
+
+}  // namespace
+
+bool WavFile::Read(const std::string & path, std::string * error) {
+  FILE * fp = std::fopen(path.c_str(), "rb");
+  if (!fp) {
+    *error = "cannot open " + path;
+    return false;
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[65536];
+  size_t n;
+  while ((n = std::fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    data.insert(data.end(), chunk, chunk + n);
+  std::fclose(fp);
+
+  if (data.size() < 12 || std::memcmp(&data[0], "RIFF", 4) || std::memcmp(&data[8], "WAVE", 4)) {
+    *error = path + ": not a RIFF/WAVE file";
+    return false;
+  }
+
+  uint16_t format = 0, bits = 0;
+  const uint8_t * pcm = nullptr;
+  size_t pcm_size = 0;
+
+  for (size_t pos = 12; pos + 8 <= data.size();) {
+    const uint8_t * hdr = &data[pos];
+    size_t size = ReadU32(hdr + 4);
+    if (pos + 8 + size > data.size())
+      size = data.size() - pos - 8;  // Note: tolerate truncated files
+    if (!std::memcmp(hdr, "fmt ", 4) && size >= 16) {
+      format = ReadU16(hdr + 8);
+      channels = ReadU16(hdr + 10);
+      samplerate = ReadU32(hdr + 12);
+      bits = ReadU16(hdr + 22);
+      if (format == 0xFFFE && size >= 40)  // WAVE_FORMAT_EXTENSIBLE, sub format in GUID
+        format = ReadU16(hdr + 32);
+    } else if (!std::memcmp(hdr, "data", 4)) {
+      pcm = hdr + 8;
+      pcm_size = size;
+    }
+    pos += 8 + size + (size & 1);
+  }
+
+  if (!pcm || !channels || !bits) {
+    *error = path + ": missing fmt or data chunk";
+    return false;
+  }
+
+  const size_t bytes = bits >> 3;
+  if (!((format == k_format_pcm && (bits == 16 || bits == 24 || bits == 32)) ||
+        (format == k_format_float && bits == 32))) {
+    *error = path + ": unsupported sample format";
+    return false;
+  }
+
+  frames = pcm_size / (bytes * channels);
+  samples.resize(frames * channels);
+
+  for (size_t i = 0; i < samples.size(); ++i) {
+    const uint8_t * p = pcm + i * bytes;
+    if (format == k_format_float) {
+      const uint32_t u = ReadU32(p);
+      std::memcpy(&samples[i], &u, sizeof(float));
+    } else if (bits == 16) {
+      samples[i] = (int16_t)ReadU16(p) * (1.f / 32768.f);
+    } else if (bits == 24) {
+      const int32_t s = (int32_t)((p[0] << 8) | (p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8;
+      samples[i] = s * (1.f / 8388608.f);
+    } else {
+      samples[i] = (int32_t)ReadU32(p) * (1.f / 2147483648.f);
+    }
+  }
+  return true;
+}
+
+bool WavFile::Write(const std::string & path, uint16_t bits, std::string * error) const {
+  if (bits != 16 && bits != 32) {
+    *error = "unsupported output bit depth";
+    return false;
+  }
+  const uint16_t format = (bits == 32) ? k_format_float : k_format_pcm;
+  const uint16_t block_align = channels * (bits >> 3);
+  const uint32_t data_size = frames * block_align;
+
+  std::vector<uint8_t> out;
+  out.reserve(44 + data_size);
+  PutTag(out, "RIFF");
+  PutU32(out, 36 + data_size);
+  PutTag(out, "WAVE");
+  PutTag(out, "fmt ");
+  PutU32(out, 16);
+  PutU16(out, format);
+  PutU16(out, channels);
+  PutU32(out, samplerate);
+  PutU32(out, samplerate * block_align);
+  PutU16(out, block_align);
+  PutU16(out, bits);
+  PutTag(out, "data");
+  PutU32(out, data_size);
+
+  for (size_t i = 0; i < frames * channels; ++i) {
+    const float s = samples[i];
+    if (bits == 32) {
+      uint32_t u;
+      std::memcpy(&u, &s, sizeof(u));
+      PutU32(out, u);
+    } else {
+      const float c = (s > 1.f) ? 1.f : (s < -1.f) ? -1.f : s;
+      PutU16(out, (uint16_t)(int16_t)(c * 32767.f));
+    }
+  }
+
+  FILE * fp = std::fopen(path.c_str(), "wb");
+  if (!fp) {
+    *error = "cannot create " + path;
+    return false;
+  }
+  const bool ok = std::fwrite(out.data(), 1, out.size(), fp) == out.size();
+  std::fclose(fp);
+  if (!ok)
+    *error = "short write to " + path;
+  return ok;
+}
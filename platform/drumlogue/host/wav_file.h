@@ -0,0 +1,40 @@
+#pragma once
+/*
+ *  File: wav_file.h
+ *
+ *  Minimal RIFF/WAVE reader and writer for the host runner.
+ *
+ *  2020-2022 (c) Korg
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct WavFile {
+  /*===========================================================================*/
+  /* Public Data Structures/Types. */
+  /*===========================================================================*/
+
+  enum {
+    k_format_pcm = 1,
+    k_format_float = 3,
+  };
+
+  uint32_t samplerate = 48000;
+  uint16_t channels = 2;
+  size_t frames = 0;
+  std::vector<float> samples;  // interleaved, channels * frames
+
+  /*===========================================================================*/
+  /* Public Methods. */
+  /*===========================================================================*/
+
+  // Note: accepts 16/24/32-bit PCM and 32-bit float data, any channel count
+  bool Read(const std::string & path, std::string * error);
+
+  // Note: bits may be 16 (PCM) or 32 (float)
+  bool Write(const std::string & path, uint16_t bits, std::string * error) const;
+};
@@ -0,0 +1,93 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    bench.c
+ * @brief   Per-callback timing statistics for the host runners benchmark mode.
+ */
+
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+uint64_t bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_u64(const void * a, const void * b) {
+  const uint64_t x = *(const uint64_t *)a;
+  const uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of sorted samples, the ceil(p * n)-th smallest */
+static double rank(const uint64_t * sorted, size_t n, double p) {
+  size_t r = (size_t)ceil(p * n);
+  if (r < 1)
+    r = 1;
+  return (double)sorted[((r < n) ? r : n) - 1];
+}
+
+void bench_compute(uint64_t * samples_ns, size_t calls, uint32_t samplerate, uint32_t frames,
+                   bench_stats_t * stats) {
+  memset(stats, 0, sizeof(*stats));
+  stats->calls = calls;
+  stats->deadline_ns = 1e9 * frames / samplerate;
+  if (calls == 0)
+    return;
+
+  qsort(samples_ns, calls, sizeof(uint64_t), cmp_u64);
+
+  double total = 0;
+  for (size_t i = 0; i < calls; ++i)
+    total += samples_ns[i];
+
+  stats->ns_per_frame = total / ((double)calls * frames);
+  stats->p50_ns = rank(samples_ns, calls, 0.5);
+  stats->p99_ns = rank(samples_ns, calls, 0.99);
+  stats->max_ns = (double)samples_ns[calls - 1];
+}
+
+void bench_print(const char * label, uint32_t frames, const bench_stats_t * s) {
+  const double d = s->deadline_ns;
+  printf("%-20s frames: %3u calls: %7zu  ns/frame: %8.2f  p50: %9.0f ns  p99: %9.0f ns  max: %9.0f ns"
+         "  deadline: %7.0f ns  load p50: %6.3f%%  p99: %6.3f%%  max: %6.3f%%\n",
+         label, frames, s->calls, s->ns_per_frame, s->p50_ns, s->p99_ns, s->max_ns, d,
+         100. * s->p50_ns / d, 100. * s->p99_ns / d, 100. * s->max_ns / d);
+}
@@ -0,0 +1,78 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    bench.h
+ * @brief   Per-callback timing statistics for the host runners benchmark mode.
+ */
+
+#ifndef __bench_h
+#define __bench_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct bench_stats {
+  size_t calls;
+  double ns_per_frame; /** Mean over all measured calls */
+  double p50_ns;       /** Per callback call */
+  double p99_ns;
+  double max_ns;
+  double deadline_ns;  /** Duration of one buffer of audio */
+} bench_stats_t;
+
+/**
+ * Monotonic clock in nanoseconds.
+ */
+uint64_t bench_now(void);
+
+/**
+ * Compute statistics from per-call durations. Sorts samples in place.
+ */
+void bench_compute(uint64_t * samples_ns, size_t calls, uint32_t samplerate, uint32_t frames,
+                   bench_stats_t * stats);
+
+/**
+ * Print statistics as a single line, stable format so results can be diffed across revisions.
+ */
+void bench_print(const char * label, uint32_t frames, const bench_stats_t * stats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __bench_h
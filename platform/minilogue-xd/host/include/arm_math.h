@@ -0,0 +1,242 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    arm_math.h
+ * @brief   Host stand-in for the CMSIS DSP/Core header.
+ *
+ * Provides the CMSIS types and the Cortex-M4 core and SIMD intrinsics
+ * referenced by cortexm4.h and fixed_math.h as portable C, with the same
+ * saturation and wrapping behavior as the target instructions. CMSIS DSP
+ * library functions (arm_*) are not provided.
+ */
+
+#ifndef __host_arm_math_h
+#define __host_arm_math_h
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __host_intrinsic static inline __attribute__((always_inline))
+
+/*===========================================================================*/
+/* Types.                                                                    */
+/*===========================================================================*/
+
+typedef int8_t  q7_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+typedef float   float32_t;
+typedef double  float64_t;
+
+#define __SIMD32_TYPE int32_t
+
+/*===========================================================================*/
+/* Core Intrinsics.                                                          */
+/*===========================================================================*/
+
+#define __NOP()
+#define __BKPT(v)
+#define __DMB() __sync_synchronize()
+#define __DSB() __sync_synchronize()
+#define __ISB() __sync_synchronize()
+
+__host_intrinsic int32_t __host_ssat(int64_t x, uint32_t bits) {
+  const int64_t max = ((int64_t)1 << (bits - 1)) - 1;
+  const int64_t min = -((int64_t)1 << (bits - 1));
+  return (int32_t)((x > max) ? max : (x < min) ? min : x);
+}
+
+__host_intrinsic uint32_t __host_usat(int64_t x, uint32_t bits) {
+  const int64_t max = ((int64_t)1 << bits) - 1;
+  return (uint32_t)((x > max) ? max : (x < 0) ? 0 : x);
+}
+
+#define __SSAT(x, bits) __host_ssat((int32_t)(x), (bits))
+#define __USAT(x, bits) __host_usat((int32_t)(x), (bits))
+
+__host_intrinsic uint8_t __CLZ(uint32_t x) {
+  return (x == 0) ? 32 : (uint8_t)__builtin_clz(x);
+}
+
+__host_intrinsic uint32_t __RBIT(uint32_t x) {
+  uint32_t r = 0;
+  for (uint32_t i = 0; i < 32; ++i, x >>= 1)
+    r = (r << 1) | (x & 1);
+  return r;
+}
+
+__host_intrinsic uint32_t __REV(uint32_t x) {
+  return __builtin_bswap32(x);
+}
+
+__host_intrinsic uint32_t __REV16(uint32_t x) {
+  return ((x & 0xFF00FF00U) >> 8) | ((x & 0x00FF00FFU) << 8);
+}
+
+__host_intrinsic int32_t __REVSH(int32_t x) {
+  return (int16_t)(((x & 0xFF00) >> 8) | ((x & 0x00FF) << 8));
+}
+
+__host_intrinsic uint32_t __ROR(uint32_t x, uint32_t n) {
+  n &= 31;
+  return (n == 0) ? x : (x >> n) | (x << (32 - n));
+}
+
+/*===========================================================================*/
+/* Saturating Arithmetic.                                                    */
+/*===========================================================================*/
+
+__host_intrinsic int32_t __QADD(int32_t a, int32_t b) {
+  return __host_ssat((int64_t)a + b, 32);
+}
+
+__host_intrinsic int32_t __QSUB(int32_t a, int32_t b) {
+  return __host_ssat((int64_t)a - b, 32);
+}
+
+/*===========================================================================*/
+/* SIMD Intrinsics.                                                          */
+/*===========================================================================*/
+
+// Note: lane helpers, 16-bit lanes are packed as [31:16] hi, [15:0] lo
+
+/* APSR.GE flags, set by the non-saturating SIMD add/sub and consumed by __SEL (per translation unit) */
+static uint32_t __host_apsr_ge __attribute__((unused));
+
+#define __host_lo16(x) ((int32_t)(int16_t)((uint32_t)(x) & 0xFFFF))
+#define __host_hi16(x) ((int32_t)(int16_t)((uint32_t)(x) >> 16))
+#define __host_pack16(hi, lo) ((int32_t)((((uint32_t)(hi) & 0xFFFF) << 16) | ((uint32_t)(lo) & 0xFFFF)))
+#define __host_lane8(x, n) ((int32_t)(int8_t)(((uint32_t)(x) >> (8 * (n))) & 0xFF))
+
+__host_intrinsic int32_t __QADD16(int32_t a, int32_t b) {
+  return __host_pack16(__host_ssat(__host_hi16(a) + __host_hi16(b), 16),
+                       __host_ssat(__host_lo16(a) + __host_lo16(b), 16));
+}
+
+__host_intrinsic int32_t __QSUB16(int32_t a, int32_t b) {
+  return __host_pack16(__host_ssat(__host_hi16(a) - __host_hi16(b), 16),
+                       __host_ssat(__host_lo16(a) - __host_lo16(b), 16));
+}
+
+__host_intrinsic int32_t __SADD16(int32_t a, int32_t b) {
+  const int32_t hi = __host_hi16(a) + __host_hi16(b);
+  const int32_t lo = __host_lo16(a) + __host_lo16(b);
+  __host_apsr_ge = ((hi >= 0) ? 0xC : 0) | ((lo >= 0) ? 0x3 : 0);
+  return __host_pack16(hi, lo);
+}
+
+__host_intrinsic int32_t __SSUB16(int32_t a, int32_t b) {
+  const int32_t hi = __host_hi16(a) - __host_hi16(b);
+  const int32_t lo = __host_lo16(a) - __host_lo16(b);
+  __host_apsr_ge = ((hi >= 0) ? 0xC : 0) | ((lo >= 0) ? 0x3 : 0);
+  return __host_pack16(hi, lo);
+}
+
+__host_intrinsic int32_t __SEL(int32_t a, int32_t b) {
+  uint32_t r = 0;
+  for (uint32_t n = 0; n < 4; ++n)
+    r |= (((__host_apsr_ge >> n) & 1) ? (uint32_t)a : (uint32_t)b) & (0xFFU << (8 * n));
+  return (int32_t)r;
+}
+
+__host_intrinsic int32_t __SHADD16(int32_t a, int32_t b) {
+  return __host_pack16((__host_hi16(a) + __host_hi16(b)) >> 1, (__host_lo16(a) + __host_lo16(b)) >> 1);
+}
+
+__host_intrinsic int32_t __SHSUB16(int32_t a, int32_t b) {
+  return __host_pack16((__host_hi16(a) - __host_hi16(b)) >> 1, (__host_lo16(a) - __host_lo16(b)) >> 1);
+}
+
+__host_intrinsic int32_t __QADD8(int32_t a, int32_t b) {
+  uint32_t r = 0;
+  for (uint32_t n = 0; n < 4; ++n)
+    r |= ((uint32_t)__host_ssat(__host_lane8(a, n) + __host_lane8(b, n), 8) & 0xFF) << (8 * n);
+  return (int32_t)r;
+}
+
+__host_intrinsic int32_t __QSUB8(int32_t a, int32_t b) {
+  uint32_t r = 0;
+  for (uint32_t n = 0; n < 4; ++n)
+    r |= ((uint32_t)__host_ssat(__host_lane8(a, n) - __host_lane8(b, n), 8) & 0xFF) << (8 * n);
+  return (int32_t)r;
+}
+
+__host_intrinsic int32_t __SSAT16(int32_t x, uint32_t bits) {
+  return __host_pack16(__host_ssat(__host_hi16(x), bits), __host_ssat(__host_lo16(x), bits));
+}
+
+__host_intrinsic uint32_t __USAT16(int32_t x, uint32_t bits) {
+  return (uint32_t)__host_pack16(__host_usat(__host_hi16(x), bits), __host_usat(__host_lo16(x), bits));
+}
+
+__host_intrinsic int32_t __SMUAD(int32_t a, int32_t b) {
+  return __host_lo16(a) * __host_lo16(b) + __host_hi16(a) * __host_hi16(b);
+}
+
+__host_intrinsic int32_t __SMUSD(int32_t a, int32_t b) {
+  return __host_lo16(a) * __host_lo16(b) - __host_hi16(a) * __host_hi16(b);
+}
+
+__host_intrinsic int32_t __SMLAD(int32_t a, int32_t b, int32_t acc) {
+  return acc + __SMUAD(a, b);
+}
+
+__host_intrinsic int32_t __SMLSD(int32_t a, int32_t b, int32_t acc) {
+  return acc + __SMUSD(a, b);
+}
+
+__host_intrinsic int32_t __SMMLA(int32_t a, int32_t b, int32_t acc) {
+  return (int32_t)((((int64_t)acc << 32) + (int64_t)a * b) >> 32);
+}
+
+__host_intrinsic int32_t __PKHBT(int32_t a, int32_t b, uint32_t shift) {
+  return (int32_t)(((uint32_t)a & 0x0000FFFFU) | (((uint32_t)b << shift) & 0xFFFF0000U));
+}
+
+__host_intrinsic int32_t __PKHTB(int32_t a, int32_t b, uint32_t shift) {
+  return (int32_t)(((uint32_t)a & 0xFFFF0000U) | (((uint32_t)(b >> shift)) & 0x0000FFFFU));
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __host_arm_math_h
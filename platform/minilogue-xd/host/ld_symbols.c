@@ -0,0 +1,70 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    ld_symbols.c
+ * @brief   Host stand-ins for the symbols defined by ld/rules.ld.
+ *
+ * The unit templates (tpl/_unit.c) are built unmodified. On the host the
+ * dynamic loader already zero-fills .bss and runs constructors, so the
+ * start and end markers alias the same object and _entry() reduces to the
+ * call to _hook_init().
+ *
+ * The module type and the SDRAM region length of the project linker script
+ * are exported for the runner, which checks the .sdram section size of the
+ * unit against the region length before running it.
+ */
+
+#include "userprg.h"
+
+#ifndef HOST_MODULE
+#define HOST_MODULE k_user_module_osc
+#endif
+
+#ifndef HOST_SDRAM_LEN
+#define HOST_SDRAM_LEN 0
+#endif
+
+typedef void (*init_fptr_t)(void);
+
+static uint8_t s_bss_marker;
+static init_fptr_t s_init_array_marker[1];
+
+extern uint8_t _bss_start __attribute__((alias("s_bss_marker")));
+extern uint8_t _bss_end __attribute__((alias("s_bss_marker")));
+
+extern init_fptr_t __init_array_start[1] __attribute__((alias("s_init_array_marker")));
+extern init_fptr_t __init_array_end[1] __attribute__((alias("s_init_array_marker")));
+
+const uint32_t _host_module = HOST_MODULE;
+const uint32_t _host_sdram_len = HOST_SDRAM_LEN;
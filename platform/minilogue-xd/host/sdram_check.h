@@ -0,0 +1,77 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    sdram_check.h
+ * @brief   SDRAM budget check for host built units.
+ *
+ * On the target the linker places __sdram buffers in the SDRAM region of the
+ * project linker script and fails when they do not fit. The host build has
+ * no such region, so the runner sums the .sdram sections of the unit shared
+ * object and compares the total against the region length exported by the
+ * host runtime (_host_sdram_len).
+ */
+
+#ifndef __sdram_check_h
+#define __sdram_check_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Total size of the .sdram sections of a shared object.
+ *
+ * @param path Shared object file.
+ * @param size Receives the size in bytes.
+ * @return 0 on success, -1 on error (reported on stderr).
+ */
+int sdram_used(const char * path, size_t * size);
+
+/**
+ * Check .sdram usage against the region length, reporting any overrun on stderr.
+ *
+ * @param path   Shared object file.
+ * @param budget SDRAM region length in bytes, 0 if the module has no SDRAM region.
+ * @param used   Receives the size in bytes, may be NULL.
+ * @return 0 if the sections fit, -1 on overrun or error.
+ */
+int sdram_check(const char * path, size_t budget, size_t * used);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __sdram_check_h
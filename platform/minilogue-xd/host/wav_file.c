@@ -0,0 +1,206 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    wav_file.c
+ * @brief   Minimal RIFF/WAVE reader and writer for the host runners.
+ */
+
+#include "wav_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define k_wav_format_pcm   (1)
+#define k_wav_format_float (3)
+
+static uint16_t get_u16(const uint8_t * p) {
+  return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t * p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_u16(FILE * fp, uint16_t x) {
+  fputc(x & 0xFF, fp);
+  fputc(x >> 8, fp);
+}
+
+static void put_u32(FILE * fp, uint32_t x) {
+  for (int i = 0; i < 4; ++i)
+    fputc((x >> (8 * i)) & 0xFF, fp);
+}
+
+int wav_alloc(wav_file_t * wav, uint32_t samplerate, uint16_t channels, size_t frames) {
+  wav->samplerate = samplerate;
+  wav->channels = channels;
+  wav->frames = frames;
+  wav->samples = (float *)calloc(frames * channels + 1, sizeof(float));
+  return (wav->samples != NULL) ? 0 : -1;
+}
+
+void wav_free(wav_file_t * wav) {
+  free(wav->samples);
+  wav->samples = NULL;
+  wav->frames = 0;
+}
+
+int wav_read(wav_file_t * wav, const char * path) {
+  memset(wav, 0, sizeof(*wav));
+
+  FILE * fp = fopen(path, "rb");
+  if (!fp) {
+    fprintf(stderr, "error: cannot open %s\n", path);
+    return -1;
+  }
+  fseek(fp, 0, SEEK_END);
+  const long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  uint8_t * data = (size > 0) ? (uint8_t *)malloc(size) : NULL;
+  const int ok = data && fread(data, 1, size, fp) == (size_t)size;
+  fclose(fp);
+
+  if (!ok || size < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4)) {
+    fprintf(stderr, "error: %s: not a RIFF/WAVE file\n", path);
+    free(data);
+    return -1;
+  }
+
+  uint16_t format = 0, channels = 0, bits = 0;
+  uint32_t samplerate = 0;
+  const uint8_t * pcm = NULL;
+  size_t pcm_size = 0;
+
+  for (size_t pos = 12; pos + 8 <= (size_t)size;) {
+    const uint8_t * hdr = data + pos;
+    size_t chunk = get_u32(hdr + 4);
+    if (pos + 8 + chunk > (size_t)size)
+      chunk = size - pos - 8;  // Note: tolerate truncated files
+    if (!memcmp(hdr, "fmt ", 4) && chunk >= 16) {
+      format = get_u16(hdr + 8);
+      channels = get_u16(hdr + 10);
+      samplerate = get_u32(hdr + 12);
+      bits = get_u16(hdr + 22);
+      if (format == 0xFFFE && chunk >= 40)  // WAVE_FORMAT_EXTENSIBLE, sub format in GUID
+        format = get_u16(hdr + 32);
+    } else if (!memcmp(hdr, "data", 4)) {
+      pcm = hdr + 8;
+      pcm_size = chunk;
+    }
+    pos += 8 + chunk + (chunk & 1);
+  }
+
+  if (!pcm || !channels
+      || !((format == k_wav_format_pcm && (bits == 16 || bits == 24 || bits == 32))
+           || (format == k_wav_format_float && bits == 32))) {
+    fprintf(stderr, "error: %s: missing chunk or unsupported sample format\n", path);
+    free(data);
+    return -1;
+  }
+
+  const size_t bytes = bits >> 3;
+  if (wav_alloc(wav, samplerate, channels, pcm_size / (bytes * channels))) {
+    fprintf(stderr, "error: out of memory\n");
+    free(data);
+    return -1;
+  }
+
+  for (size_t i = 0; i < wav->frames * channels; ++i) {
+    const uint8_t * p = pcm + i * bytes;
+    if (format == k_wav_format_float) {
+      const uint32_t u = get_u32(p);
+      memcpy(&wav->samples[i], &u, sizeof(float));
+    } else if (bits == 16) {
+      wav->samples[i] = (int16_t)get_u16(p) * (1.f / 32768.f);
+    } else if (bits == 24) {
+      const int32_t s = (int32_t)((p[0] << 8) | (p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8;
+      wav->samples[i] = s * (1.f / 8388608.f);
+    } else {
+      wav->samples[i] = (int32_t)get_u32(p) * (1.f / 2147483648.f);
+    }
+  }
+
+  free(data);
+  return 0;
+}
+
+int wav_write(const wav_file_t * wav, const char * path, uint16_t bits) {
+  if (bits != 16 && bits != 32) {
+    fprintf(stderr, "error: unsupported output bit depth: %u\n", bits);
+    return -1;
+  }
+
+  FILE * fp = fopen(path, "wb");
+  if (!fp) {
+    fprintf(stderr, "error: cannot create %s\n", path);
+    return -1;
+  }
+
+  const uint16_t block_align = wav->channels * (bits >> 3);
+  const uint32_t data_size = wav->frames * block_align;
+
+  fwrite("RIFF", 1, 4, fp);
+  put_u32(fp, 36 + data_size);
+  fwrite("WAVEfmt ", 1, 8, fp);
+  put_u32(fp, 16);
+  put_u16(fp, (bits == 32) ? k_wav_format_float : k_wav_format_pcm);
+  put_u16(fp, wav->channels);
+  put_u32(fp, wav->samplerate);
+  put_u32(fp, wav->samplerate * block_align);
+  put_u16(fp, block_align);
+  put_u16(fp, bits);
+  fwrite("data", 1, 4, fp);
+  put_u32(fp, data_size);
+
+  for (size_t i = 0; i < wav->frames * wav->channels; ++i) {
+    const float s = wav->samples[i];
+    if (bits == 32) {
+      uint32_t u;
+      memcpy(&u, &s, sizeof(u));
+      put_u32(fp, u);
+    } else {
+      const float c = (s > 1.f) ? 1.f : (s < -1.f) ? -1.f : s;
+      put_u16(fp, (uint16_t)(int16_t)(c * 32767.f));
+    }
+  }
+
+  const int err = ferror(fp);
+  fclose(fp);
+  if (err) {
+    fprintf(stderr, "error: short write to %s\n", path);
+    return -1;
+  }
+  return 0;
+}
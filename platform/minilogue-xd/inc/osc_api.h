@@ -568,6 +568,53 @@ extern "C" {
     const float fr = k_waves_frrecip * (float)(x & ((1U<<k_waves_u32shift)-1));
     return linintf(fr, w[x0], w[x1]);
   }
+
+  /**
+   * Scan a wave over a block of samples.
+   *
+   * Unlike osc_wave_scanuf(), a full cycle spans the whole 32-bit phase range,
+   * so the phase wraps around on overflow without a float to integer
+   * conversion. Four samples are computed per iteration.
+   *
+   * @param w      Wave, e.g. wavesA[0].
+   * @param x      Phase of the first sample, a full cycle over the 32-bit range.
+   * @param dx     Phase increment per sample, e.g. (uint32_t)(w0 * 4294967296.f) for w0 in cycles per sample.
+   * @param out    Output buffer.
+   * @param frames Size of output buffer.
+   * @return       Phase after the block, to pass as x for the next block.
+   */
+  static inline __attribute__((always_inline, optimize("Ofast")))
+  uint32_t osc_wave_scan_block(const float *w, uint32_t x, const uint32_t dx, float * __restrict out, const uint32_t frames) {
+    const uint32_t shift = 32 - k_waves_size_exp;
+    const uint32_t frmask = (1U<<shift)-1;
+    const float frrecip = 1.f / (1U<<shift);
+    const float * const out_e4 = out + (frames & ~3U);
+    const float * const out_e = out + frames;
+    
+    for (; out != out_e4; out += 4) {
+      const uint32_t xa = x;
+      const uint32_t xb = xa + dx;
+      const uint32_t xc = xb + dx;
+      const uint32_t xd = xc + dx;
+      x = xd + dx;
+      
+      const uint32_t a0 = xa>>shift;
+      const uint32_t b0 = xb>>shift;
+      const uint32_t c0 = xc>>shift;
+      const uint32_t d0 = xd>>shift;
+      out[0] = linintf(frrecip * (float)(xa & frmask), w[a0], w[(a0 + 1) & k_waves_mask]);
+      out[1] = linintf(frrecip * (float)(xb & frmask), w[b0], w[(b0 + 1) & k_waves_mask]);
+      out[2] = linintf(frrecip * (float)(xc & frmask), w[c0], w[(c0 + 1) & k_waves_mask]);
+      out[3] = linintf(frrecip * (float)(xd & frmask), w[d0], w[(d0 + 1) & k_waves_mask]);
+    }
+    
+    for (; out != out_e; ++out) {
+      const uint32_t x0 = x>>shift;
+      *out = linintf(frrecip * (float)(x & frmask), w[x0], w[(x0 + 1) & k_waves_mask]);
+      x += dx;
+    }
+    return x;
+  }
   
   /** @} */
   
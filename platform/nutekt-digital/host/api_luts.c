@@ -0,0 +1,147 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    api_luts.c
+ * @brief   Lookup tables and noise source shared by the emulated runtime APIs.
+ *
+ * Tables are generated from the definitions documented in osc_api.h and
+ * fx_api.h, in double precision and rounded once to float.
+ */
+
+#include "api_luts.h"
+
+#include <math.h>
+
+/*===========================================================================*/
+/* Lookup Tables.                                                            */
+/*===========================================================================*/
+
+float wt_sine_lut_f[k_host_wt_sine_lut_size];
+float log_lut_f[k_host_log_lut_size];
+float tanpi_lut_f[k_host_tanpi_lut_size];
+float sqrtm2log_lut_f[k_host_sqrtm2log_lut_size];
+float cubicsat_lut_f[k_host_cubicsat_lut_size];
+float schetzen_lut_f[k_host_schetzen_lut_size];
+float bitres_lut_f[k_host_bitres_lut_size];
+
+static int s_luts_ready = 0;
+
+/*
+ * Cubic curve above 1-1/sqrt(3), linear with gain 1/(1-(1/sqrt(3))^3) below.
+ */
+static double cubicsat(double x) {
+  const double t = 1.0 - 1.0 / sqrt(3.0);
+  const double g = 1.0 / (1.0 - pow(1.0 - t, 3.0));
+  return (x <= t) ? g * x : g * (x - pow(x - t, 3.0));
+}
+
+/*
+ * Schetzen soft clipping curve.
+ */
+static double schetzen(double x) {
+  if (x < 1.0 / 3.0)
+    return 2.0 * x;
+  if (x < 2.0 / 3.0)
+    return (3.0 - (2.0 - 3.0 * x) * (2.0 - 3.0 * x)) / 3.0;
+  return 1.0;
+}
+
+void host_luts_init(void) {
+  if (s_luts_ready)
+    return;
+
+  // Half period of sin(2*pi*x), wrapped and negated by the lookup functions
+  for (int i = 0; i < k_host_wt_sine_lut_size; ++i)
+    wt_sine_lut_f[i] = (float)sin(M_PI * i / (k_host_wt_sine_lut_size - 1));
+
+  // log(x) in [0.00001, 1.0]
+  for (int i = 0; i < k_host_log_lut_size; ++i) {
+    const double x = (double)i / (k_host_log_lut_size - 1);
+    log_lut_f[i] = (float)log((x < 0.00001) ? 0.00001 : x);
+  }
+
+  // tan(pi*x) in [0, 0.49]
+  for (int i = 0; i < k_host_tanpi_lut_size; ++i)
+    tanpi_lut_f[i] = (float)tan(M_PI * 0.49 * i / (k_host_tanpi_lut_size - 1));
+
+  // sqrt(-2*log(x)) in [0.005, 1.0]
+  for (int i = 0; i < k_host_sqrtm2log_lut_size; ++i) {
+    const double x = 0.005 + 0.995 * i / (k_host_sqrtm2log_lut_size - 1);
+    sqrtm2log_lut_f[i] = (float)sqrt(-2.0 * log(x));
+  }
+
+  // Saturation curves, positive half in [0, 1.0]
+  for (int i = 0; i < k_host_cubicsat_lut_size; ++i)
+    cubicsat_lut_f[i] = (float)cubicsat((double)i / (k_host_cubicsat_lut_size - 1));
+
+  for (int i = 0; i < k_host_schetzen_lut_size; ++i)
+    schetzen_lut_f[i] = (float)schetzen((double)i / (k_host_schetzen_lut_size - 1));
+
+  // Quantization scale, fractional bit depth exponentially mapped from 24 bits down to 1 bit
+  for (int i = 0; i < k_host_bitres_lut_size; ++i) {
+    const double bits = 24.0 * pow(1.0 / 24.0, (double)i / (k_host_bitres_lut_size - 1));
+    bitres_lut_f[i] = (float)pow(2.0, bits - 1.0);
+  }
+
+  s_luts_ready = 1;
+}
+
+/*===========================================================================*/
+/* Noise Source.                                                             */
+/*===========================================================================*/
+
+static uint32_t s_rand_state = 1;
+
+uint32_t host_rand(void) {
+  // Park-Miller "minimal standard" (a = 16807, m = 2^31-1) with Carta's reduction
+  uint32_t lo = 16807 * (s_rand_state & 0xFFFF);
+  const uint32_t hi = 16807 * (s_rand_state >> 16);
+  lo += (hi & 0x7FFF) << 16;
+  lo += hi >> 15;
+  if (lo > 0x7FFFFFFF)
+    lo -= 0x7FFFFFFF;
+  return (s_rand_state = lo);
+}
+
+float host_white(void) {
+  // Note: radius bounded by the [0.005, 1.0] input range of sqrt(-2*log(x))
+  static const float k_radius_max_recip = 0.30720f;  // 1/sqrt(-2*log(0.005))
+  const float u0 = 0.005f + 0.995f * (host_rand() * 4.656612873e-10f);
+  const float u1 = host_rand() * 4.656612873e-10f;
+  return k_radius_max_recip * sqrtf(-2.f * logf(u0)) * cosf(2.f * (float)M_PI * u1);
+}
+
+uint32_t host_mcu_hash(void) {
+  return 0x484F5354;  // "HOST"
+}
@@ -0,0 +1,96 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    api_luts.h
+ * @brief   Lookup tables and noise source shared by the emulated runtime APIs.
+ *
+ * The tables are defined here without the const qualifier so that they can
+ * be filled at load time. Units see them through the const declarations of
+ * osc_api.h and fx_api.h, which must therefore not be included by the
+ * runtime implementation files.
+ */
+
+#ifndef __api_luts_h
+#define __api_luts_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Note: sizes mirror the k_*_lut_size definitions of osc_api.h and fx_api.h */
+#define k_host_wt_sine_lut_size   (129)
+#define k_host_log_lut_size       (257)
+#define k_host_tanpi_lut_size     (257)
+#define k_host_sqrtm2log_lut_size (257)
+#define k_host_cubicsat_lut_size  (129)
+#define k_host_schetzen_lut_size  (129)
+#define k_host_bitres_lut_size    (129)
+
+extern float wt_sine_lut_f[k_host_wt_sine_lut_size];
+extern float log_lut_f[k_host_log_lut_size];
+extern float tanpi_lut_f[k_host_tanpi_lut_size];
+extern float sqrtm2log_lut_f[k_host_sqrtm2log_lut_size];
+extern float cubicsat_lut_f[k_host_cubicsat_lut_size];
+extern float schetzen_lut_f[k_host_schetzen_lut_size];
+extern float bitres_lut_f[k_host_bitres_lut_size];
+
+/**
+ * Fill the shared lookup tables. Idempotent.
+ */
+void host_luts_init(void);
+
+/**
+ * Park-Miller-Carta pseudo-random generator.
+ *
+ * @return Value in [1, 2^31-2].
+ */
+uint32_t host_rand(void);
+
+/**
+ * Gaussian white noise, Box-Muller transform scaled to stay within [-1.0, 1.0].
+ */
+float host_white(void);
+
+/**
+ * Fixed stand-in for the MCU specific hash.
+ */
+uint32_t host_mcu_hash(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __api_luts_h
@@ -0,0 +1,106 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    fx_api.c
+ * @brief   Host implementation of the effect runtime API (ld/main_api.syms).
+ *
+ * Provides every symbol that modulation, delay and reverb effect units
+ * resolve against the firmware with --just-symbols. Inline API functions of
+ * fx_api.h are compiled from the SDK header itself, only the firmware side
+ * is emulated here. See osc_api.c for notes on table contents.
+ */
+
+#include "userprg.h"
+
+#include <math.h>
+
+#include "api_luts.h"
+
+/* Note: sizes mirror fx_api.h, which cannot be included here (see api_luts.h) */
+#define k_pow2_lut_size (257)
+
+/*===========================================================================*/
+/* Runtime Environment.                                                      */
+/*===========================================================================*/
+
+const uint32_t k_fx_api_platform = USER_TARGET_PLATFORM;
+const uint32_t k_fx_api_version = USER_API_VERSION;
+
+static float s_bpm = 120.f;
+
+uint32_t _fx_mcu_hash(void) {
+  return host_mcu_hash();
+}
+
+uint16_t _fx_get_bpm(void) {
+  return (uint16_t)(s_bpm * 10.f + 0.5f);
+}
+
+float _fx_get_bpmf(void) {
+  return s_bpm;
+}
+
+/**
+ * Set the tempo reported to the unit. Host only, called by the runner.
+ */
+void host_fx_set_bpm(float bpm) {
+  s_bpm = bpm;
+}
+
+/*===========================================================================*/
+/* Lookup Tables.                                                            */
+/*===========================================================================*/
+
+float pow2_lut_f[k_pow2_lut_size];
+
+__attribute__((constructor(101)))
+static void fx_api_init(void) {
+  host_luts_init();
+
+  // 2^x in [0, 3.0]
+  for (int i = 0; i < k_pow2_lut_size; ++i)
+    pow2_lut_f[i] = (float)pow(2.0, 3.0 * i / (k_pow2_lut_size - 1));
+}
+
+/*===========================================================================*/
+/* Noise Source.                                                             */
+/*===========================================================================*/
+
+uint32_t _fx_rand(void) {
+  return host_rand();
+}
+
+float _fx_white(void) {
+  return host_white();
+}
@@ -0,0 +1,428 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    fx_runner.c
+ * @brief   Offline host runner for user modulation, delay and reverb effects.
+ *
+ * Loads a unit built as a native shared object against the emulated
+ * runtime (fx_api.c), checks its .sdram sections against the SDRAM region
+ * of the project linker script, and drives its hooks the way the firmware
+ * does: _entry(), parameter changes, _hook_resume(), then _hook_process()
+ * per buffer of up to 64 interleaved stereo frames, and _hook_suspend() at
+ * the end.
+ */
+
+#include <dlfcn.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "userprg.h"
+
+#include "bench.h"
+#include "sdram_check.h"
+#include "wav_file.h"
+
+#define k_samplerate            (48000)
+#define k_channels              (2)
+#define k_max_frames_per_buffer (64)
+#define k_max_param_settings    (32)
+#define k_num_fx_param_id       (4)
+
+/*===========================================================================*/
+/* Unit Hooks.                                                               */
+/*===========================================================================*/
+
+/*
+ * Note: usermodfx.h, userdelfx.h and userrevfx.h declare _hook_process with
+ *       different signatures and cannot be included together.
+ */
+typedef void (*fx_func_entry_t)(uint32_t platform, uint32_t api);
+typedef void (*fx_func_modfx_process_t)(const float * main_xn, float * main_yn,
+                                        const float * sub_xn, float * sub_yn, uint32_t frames);
+typedef void (*fx_func_process_t)(float * xn, uint32_t frames);
+typedef void (*fx_func_suspend_t)(void);
+typedef void (*fx_func_resume_t)(void);
+typedef void (*fx_func_param_t)(uint8_t index, int32_t value);
+typedef void (*fx_func_set_bpm_t)(float bpm);
+
+typedef struct fx_unit {
+  void *            handle;
+  uint32_t          module;
+  uint32_t          sdram_len;
+  fx_func_entry_t   entry;
+  void *            process;
+  fx_func_suspend_t suspend;
+  fx_func_resume_t  resume;
+  fx_func_param_t   param;
+  fx_func_set_bpm_t set_bpm;
+} fx_unit_t;
+
+static const char * module_name(uint32_t module) {
+  switch (module) {
+  case k_user_module_modfx:
+    return "modfx";
+  case k_user_module_delfx:
+    return "delfx";
+  case k_user_module_revfx:
+    return "revfx";
+  default:
+    return "unknown";
+  }
+}
+
+static int unit_load(fx_unit_t * unit, const char * path) {
+  memset(unit, 0, sizeof(*unit));
+  unit->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (!unit->handle) {
+    fprintf(stderr, "error: %s\n", dlerror());
+    return -1;
+  }
+
+  // Note: tpl/_unit.c provides weak defaults, the host runtime (ld_symbols.c, fx_api.c) the rest
+  const uint32_t * module = NULL;
+  const uint32_t * sdram_len = NULL;
+  struct {
+    const char * name;
+    void ** ptr;
+  } syms[] = {
+    {"_entry", (void **)&unit->entry},
+    {"_hook_process", (void **)&unit->process},
+    {"_hook_suspend", (void **)&unit->suspend},
+    {"_hook_resume", (void **)&unit->resume},
+    {"_hook_param", (void **)&unit->param},
+    {"host_fx_set_bpm", (void **)&unit->set_bpm},
+    {"_host_module", (void **)&module},
+    {"_host_sdram_len", (void **)&sdram_len},
+  };
+
+  for (size_t i = 0; i < sizeof(syms) / sizeof(syms[0]); ++i) {
+    *syms[i].ptr = dlsym(unit->handle, syms[i].name);
+    if (!*syms[i].ptr) {
+      fprintf(stderr, "error: %s: missing symbol %s\n", path, syms[i].name);
+      dlclose(unit->handle);
+      unit->handle = NULL;
+      return -1;
+    }
+  }
+
+  unit->module = *module;
+  unit->sdram_len = *sdram_len;
+  if (unit->module != k_user_module_modfx && unit->module != k_user_module_delfx
+      && unit->module != k_user_module_revfx) {
+    fprintf(stderr, "error: %s: not an effect unit (module %u)\n", path, unit->module);
+    dlclose(unit->handle);
+    unit->handle = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+/*===========================================================================*/
+/* Options.                                                                  */
+/*===========================================================================*/
+
+typedef struct param_setting {
+  uint16_t index;
+  uint16_t value;
+} param_setting_t;
+
+typedef struct options {
+  const char *    unit_path;
+  const char *    input_path;
+  const char *    output_path;
+  uint16_t        output_bits;
+  uint32_t        frames_per_buffer;
+  float           duration;
+  float           tail;
+  float           bpm;
+  int             verbose;
+  size_t          bench_calls;
+  const char *    bench_label;
+  size_t          param_count;
+  param_setting_t params[k_max_param_settings];
+} options_t;
+
+static void usage(const char * argv0) {
+  fprintf(stderr,
+          "Usage: %s [options] <unit.so>\n"
+          "\n"
+          "  -i FILE          Input WAV file, mono inputs are duplicated (default: unit impulse)\n"
+          "  -o FILE          Output WAV file (stereo)\n"
+          "  -b BITS          Output bit depth: 16 or 32 (float, default)\n"
+          "  -f FRAMES        Frames per buffer, 1 to 64 (default: 64)\n"
+          "  -d SECONDS       Render duration without input file (default: 2)\n"
+          "  -T SECONDS       Extra tail rendered after the input ends (default: 0)\n"
+          "  -p INDEX=VALUE   Set parameter after initialization (repeatable)\n"
+          "                   INDEX 0: time, 1: depth, 3: shift-depth (delfx/revfx) (10-bit)\n"
+          "  -t BPM           Tempo reported by the runtime (default: 120)\n"
+          "  -v               Print module type and SDRAM usage\n"
+          "  -B CALLS         Benchmark mode: time CALLS _hook_process calls, no WAV output\n"
+          "  -L LABEL         Label printed with benchmark results (default: unit file name)\n",
+          argv0);
+}
+
+static int parse_options(int argc, char ** argv, options_t * o) {
+  memset(o, 0, sizeof(*o));
+  o->output_bits = 32;
+  o->frames_per_buffer = k_max_frames_per_buffer;
+  o->duration = 2.f;
+  o->bpm = 120.f;
+
+  int c;
+  while ((c = getopt(argc, argv, "i:o:b:f:d:T:p:t:vB:L:h")) != -1) {
+    switch (c) {
+    case 'i':
+      o->input_path = optarg;
+      break;
+    case 'o':
+      o->output_path = optarg;
+      break;
+    case 'b':
+      o->output_bits = atoi(optarg);
+      break;
+    case 'f':
+      o->frames_per_buffer = atoi(optarg);
+      break;
+    case 'd':
+      o->duration = atof(optarg);
+      break;
+    case 'T':
+      o->tail = atof(optarg);
+      break;
+    case 'p': {
+      unsigned index, value;
+      if (o->param_count == k_max_param_settings || sscanf(optarg, "%u=%u", &index, &value) != 2
+          || index >= k_num_fx_param_id || value > 1023) {
+        fprintf(stderr, "error: invalid parameter setting: %s\n", optarg);
+        return -1;
+      }
+      o->params[o->param_count].index = index;
+      o->params[o->param_count].value = value;
+      ++o->param_count;
+    } break;
+    case 't':
+      o->bpm = atof(optarg);
+      break;
+    case 'v':
+      o->verbose = 1;
+      break;
+    case 'B':
+      o->bench_calls = strtoul(optarg, NULL, 10);
+      break;
+    case 'L':
+      o->bench_label = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return -1;
+    }
+  }
+
+  if (optind != argc - 1) {
+    usage(argv[0]);
+    return -1;
+  }
+  o->unit_path = argv[optind];
+
+  if (o->frames_per_buffer < 1 || o->frames_per_buffer > k_max_frames_per_buffer) {
+    fprintf(stderr, "error: frames per buffer must be in [1, %u]\n", k_max_frames_per_buffer);
+    return -1;
+  }
+  if (o->bpm < 10.f || o->bpm > 600.f) {
+    fprintf(stderr, "error: tempo must be in [10, 600]\n");
+    return -1;
+  }
+  if (!o->bench_label) {
+    const char * slash = strrchr(o->unit_path, '/');
+    o->bench_label = slash ? slash + 1 : o->unit_path;
+  }
+  return 0;
+}
+
+/*===========================================================================*/
+/* Rendering.                                                                */
+/*===========================================================================*/
+
+static void unit_start(const options_t * o, const fx_unit_t * unit) {
+  unit->set_bpm(o->bpm);
+  unit->entry(USER_TARGET_PLATFORM | unit->module, USER_API_VERSION);
+  for (size_t i = 0; i < o->param_count; ++i)
+    unit->param(o->params[i].index, o->params[i].value);
+  unit->resume();
+}
+
+/*
+ * Process one buffer of interleaved stereo frames. Modulation effects get a
+ * silent sub timbre and write to a separate output, others process in place.
+ */
+static void unit_process(const fx_unit_t * unit, float * buf, uint32_t frames) {
+  if (unit->module == k_user_module_modfx) {
+    static const float k_sub_xn[k_max_frames_per_buffer * k_channels] = {0};
+    float main_yn[k_max_frames_per_buffer * k_channels];
+    float sub_yn[k_max_frames_per_buffer * k_channels];
+    ((fx_func_modfx_process_t)unit->process)(buf, main_yn, k_sub_xn, sub_yn, frames);
+    memcpy(buf, main_yn, frames * k_channels * sizeof(float));
+  } else {
+    ((fx_func_process_t)unit->process)(buf, frames);
+  }
+}
+
+static int render(const options_t * o, const fx_unit_t * unit) {
+  wav_file_t input;
+  memset(&input, 0, sizeof(input));
+  if (o->input_path) {
+    if (wav_read(&input, o->input_path))
+      return -1;
+    if (input.samplerate != k_samplerate)
+      fprintf(stderr, "warning: input samplerate %u Hz, rendering at %u Hz\n", input.samplerate,
+              k_samplerate);
+  }
+
+  const size_t total = o->input_path ? input.frames + (size_t)(o->tail * k_samplerate)
+                                     : (size_t)(o->duration * k_samplerate);
+
+  wav_file_t wav;
+  if (wav_alloc(&wav, k_samplerate, k_channels, total)) {
+    fprintf(stderr, "error: out of memory\n");
+    wav_free(&input);
+    return -1;
+  }
+
+  unit_start(o, unit);
+
+  float buf[k_max_frames_per_buffer * k_channels];
+  for (size_t pos = 0; pos < total;) {
+    uint32_t frames = o->frames_per_buffer;
+    if (frames > total - pos)
+      frames = total - pos;
+
+    for (uint32_t f = 0; f < frames; ++f) {
+      for (uint32_t ch = 0; ch < k_channels; ++ch) {
+        float s = 0.f;
+        if (!o->input_path)
+          s = (pos + f == 0) ? 1.f : 0.f;
+        else if (pos + f < input.frames)
+          s = input.samples[(pos + f) * input.channels + ((ch < input.channels) ? ch : 0)];
+        buf[f * k_channels + ch] = s;
+      }
+    }
+
+    unit_process(unit, buf, frames);
+    memcpy(&wav.samples[pos * k_channels], buf, frames * k_channels * sizeof(float));
+    pos += frames;
+  }
+
+  unit->suspend();
+
+  int err = 0;
+  if (o->output_path)
+    err = wav_write(&wav, o->output_path, o->output_bits);
+  if (!err)
+    printf("rendered %zu frames (%.3f s) in buffers of %u frames, %s input\n", total,
+           (double)total / k_samplerate, o->frames_per_buffer, o->input_path ? o->input_path : "impulse");
+  wav_free(&wav);
+  wav_free(&input);
+  return err;
+}
+
+static int benchmark(const options_t * o, const fx_unit_t * unit) {
+  uint64_t * samples_ns = (uint64_t *)malloc(o->bench_calls * sizeof(uint64_t));
+  if (!samples_ns) {
+    fprintf(stderr, "error: out of memory\n");
+    return -1;
+  }
+
+  unit_start(o, unit);
+
+  // Note: effects are fed deterministic white noise so that processing is never trivially silent
+  float noise[k_max_frames_per_buffer * k_channels];
+  uint32_t seed = 0x12345678U;
+  for (uint32_t i = 0; i < k_max_frames_per_buffer * k_channels; ++i) {
+    seed = seed * 1664525U + 1013904223U;
+    noise[i] = (int32_t)seed * (0.5f / 2147483648.f);
+  }
+
+  float buf[k_max_frames_per_buffer * k_channels];
+  const size_t buf_size = o->frames_per_buffer * k_channels * sizeof(float);
+
+  // Note: warm up caches and branch predictors before measuring
+  const size_t warmup = (o->bench_calls / 10 > 16) ? o->bench_calls / 10 : 16;
+  for (size_t i = 0; i < warmup; ++i) {
+    memcpy(buf, noise, buf_size);
+    unit_process(unit, buf, o->frames_per_buffer);
+  }
+
+  for (size_t i = 0; i < o->bench_calls; ++i) {
+    memcpy(buf, noise, buf_size);
+    const uint64_t t0 = bench_now();
+    unit_process(unit, buf, o->frames_per_buffer);
+    samples_ns[i] = bench_now() - t0;
+  }
+
+  unit->suspend();
+
+  bench_stats_t stats;
+  bench_compute(samples_ns, o->bench_calls, k_samplerate, o->frames_per_buffer, &stats);
+  bench_print(o->bench_label, o->frames_per_buffer, &stats);
+  free(samples_ns);
+  return 0;
+}
+
+int main(int argc, char ** argv) {
+  options_t opt;
+  if (parse_options(argc, argv, &opt))
+    return EXIT_FAILURE;
+
+  fx_unit_t unit;
+  if (unit_load(&unit, opt.unit_path))
+    return EXIT_FAILURE;
+
+  // Note: refuse to run units that would not link on the target
+  size_t sdram_used = 0;
+  if (sdram_check(opt.unit_path, unit.sdram_len, &sdram_used)) {
+    dlclose(unit.handle);
+    return EXIT_FAILURE;
+  }
+
+  if (opt.verbose)
+    printf("module %s, SDRAM %zu / %u bytes (%.1f%%)\n", module_name(unit.module), sdram_used,
+           unit.sdram_len, unit.sdram_len ? 100.0 * sdram_used / unit.sdram_len : 0.0);
+
+  const int err = (opt.bench_calls > 0) ? benchmark(&opt, &unit) : render(&opt, &unit);
+
+  dlclose(unit.handle);
+  return err ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    sdram_check.c
+ * @brief   SDRAM budget check for host built units.
+ */
+
+#include "sdram_check.h"
+
+#include <link.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int sdram_used(const char * path, size_t * size) {
+  *size = 0;
+
+  FILE * fp = fopen(path, "rb");
+  if (!fp) {
+    fprintf(stderr, "error: cannot open %s\n", path);
+    return -1;
+  }
+
+  ElfW(Ehdr) ehdr;
+  ElfW(Shdr) * shdrs = NULL;
+  char * names = NULL;
+  int ret = -1;
+
+  if (fread(&ehdr, sizeof(ehdr), 1, fp) != 1 || memcmp(ehdr.e_ident, ELFMAG, SELFMAG)
+      || ehdr.e_shentsize != sizeof(ElfW(Shdr)) || ehdr.e_shstrndx >= ehdr.e_shnum) {
+    fprintf(stderr, "error: %s: not a native ELF shared object\n", path);
+    goto done;
+  }
+
+  shdrs = (ElfW(Shdr) *)malloc(ehdr.e_shnum * sizeof(ElfW(Shdr)));
+  if (!shdrs || fseek(fp, ehdr.e_shoff, SEEK_SET)
+      || fread(shdrs, sizeof(ElfW(Shdr)), ehdr.e_shnum, fp) != ehdr.e_shnum) {
+    fprintf(stderr, "error: %s: cannot read section headers\n", path);
+    goto done;
+  }
+
+  const ElfW(Shdr) * strtab = &shdrs[ehdr.e_shstrndx];
+  names = (char *)malloc(strtab->sh_size + 1);
+  if (!names || fseek(fp, strtab->sh_offset, SEEK_SET)
+      || fread(names, 1, strtab->sh_size, fp) != strtab->sh_size) {
+    fprintf(stderr, "error: %s: cannot read section names\n", path);
+    goto done;
+  }
+  names[strtab->sh_size] = '\0';
+
+  // Note: same selection as rules.ld, KEEP(*(.sdram*))
+  for (size_t i = 0; i < ehdr.e_shnum; ++i) {
+    if (shdrs[i].sh_name < strtab->sh_size && !strncmp(&names[shdrs[i].sh_name], ".sdram", 6))
+      *size += shdrs[i].sh_size;
+  }
+  ret = 0;
+
+ done:
+  free(names);
+  free(shdrs);
+  fclose(fp);
+  return ret;
+}
+
+int sdram_check(const char * path, size_t budget, size_t * used) {
+  size_t size;
+  if (sdram_used(path, &size))
+    return -1;
+
+  if (used)
+    *used = size;
+
+  if (size > budget) {
+    if (budget == 0)
+      fprintf(stderr, "error: %s: module has no SDRAM region, .sdram uses %zu bytes\n", path, size);
+    else
+      fprintf(stderr, "error: %s: region SDRAM overflowed by %zu bytes (%zu used, %zu available)\n",
+              path, size - budget, size, budget);
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,86 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    wav_file.h
+ * @brief   Minimal RIFF/WAVE reader and writer for the host runners.
+ */
+
+#ifndef __wav_file_h
+#define __wav_file_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct wav_file {
+  uint32_t samplerate;
+  uint16_t channels;
+  size_t   frames;
+  float *  samples; /** Interleaved, channels * frames */
+} wav_file_t;
+
+/**
+ * Allocate zeroed sample storage.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+int wav_alloc(wav_file_t * wav, uint32_t samplerate, uint16_t channels, size_t frames);
+
+/**
+ * Release sample storage.
+ */
+void wav_free(wav_file_t * wav);
+
+/**
+ * Read file, accepts 16/24/32-bit PCM and 32-bit float data, any channel count.
+ *
+ * @return 0 on success, -1 on error (reported on stderr).
+ */
+int wav_read(wav_file_t * wav, const char * path);
+
+/**
+ * Write samples to file, as 16-bit PCM or 32-bit float.
+ *
+ * @return 0 on success, -1 on error (reported on stderr).
+ */
+int wav_write(const wav_file_t * wav, const char * path, uint16_t bits);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __wav_file_h
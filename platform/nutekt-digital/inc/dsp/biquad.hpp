@@ -671,6 +671,272 @@ namespace dsp {
     float mD0, mD1, mW0, mW1;
     float mZ1, mZ2;
   };    
+
+  /**
+   * Cascade of second order transposed form 2 Bi-Quad sections with block processing.
+   *
+   * A whole buffer is filtered one section after the other, so that
+   * coefficients and delays stay in registers for the duration of the block
+   * instead of being reloaded for every sample.
+   *
+   * @tparam N Number of sections.
+   */
+  template<uint32_t N>
+  struct BiQuadCascade {
+
+    /*=====================================================================*/
+    /* Constructor / Destructor.                                           */
+    /*=====================================================================*/
+
+    /**
+     * Default constructor
+     */
+    BiQuadCascade(void)
+    {
+      flush();
+    }
+
+    /*=====================================================================*/
+    /* Public Methods.                                                     */
+    /*=====================================================================*/
+
+    /**
+     * Flush internal delays of all sections
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void flush(void) {
+      for (uint32_t i = 0; i < N; ++i)
+        mZ1[i] = mZ2[i] = 0;
+    }
+
+    /**
+     * Process a buffer through all sections
+     *
+     * @param x  Input buffer
+     * @param y  Output buffer, may be the same as input buffer
+     * @param frames  Size of buffers
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void process(const float * x, float * y, const uint32_t frames) {
+      const float * src = x;
+      for (uint32_t s = 0; s < N; ++s, src = y)
+        process_section(s, src, y, frames);
+    }
+
+    /**
+     * Process one sample through all sections
+     *
+     * @param xn  Input sample
+     *
+     * @return Output sample
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    float process(float xn) {
+      for (uint32_t s = 0; s < N; ++s) {
+        const BiQuad::Coeffs & c = mCoeffs[s];
+        const float acc = c.ff0 * xn + mZ1[s];
+        mZ1[s] = c.ff1 * xn + mZ2[s] - c.fb1 * acc;
+        mZ2[s] = c.ff2 * xn - c.fb2 * acc;
+        xn = acc;
+      }
+      return xn;
+    }
+
+    /*=====================================================================*/
+    /* Member Variables.                                                   */
+    /*=====================================================================*/
+
+    /** Coefficients of each section */
+    BiQuad::Coeffs mCoeffs[N];
+    float mZ1[N], mZ2[N];
+
+  private:
+
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void process_section(const uint32_t s, const float * src, float * dst, const uint32_t frames) {
+      const float ff0 = mCoeffs[s].ff0;
+      const float ff1 = mCoeffs[s].ff1;
+      const float ff2 = mCoeffs[s].ff2;
+      const float fb1 = mCoeffs[s].fb1;
+      const float fb2 = mCoeffs[s].fb2;
+      float z1 = mZ1[s];
+      float z2 = mZ2[s];
+
+      // Note: unrolled by 4, inputs are read before outputs are written so that src may alias dst
+      uint32_t i = 0;
+      for (; i + 4 <= frames; i += 4) {
+        const float x0 = src[i], x1 = src[i+1], x2 = src[i+2], x3 = src[i+3];
+        const float y0 = ff0 * x0 + z1;
+        z1 = ff1 * x0 + z2 - fb1 * y0;
+        z2 = ff2 * x0 - fb2 * y0;
+        const float y1 = ff0 * x1 + z1;
+        z1 = ff1 * x1 + z2 - fb1 * y1;
+        z2 = ff2 * x1 - fb2 * y1;
+        const float y2 = ff0 * x2 + z1;
+        z1 = ff1 * x2 + z2 - fb1 * y2;
+        z2 = ff2 * x2 - fb2 * y2;
+        const float y3 = ff0 * x3 + z1;
+        z1 = ff1 * x3 + z2 - fb1 * y3;
+        z2 = ff2 * x3 - fb2 * y3;
+        dst[i] = y0;
+        dst[i+1] = y1;
+        dst[i+2] = y2;
+        dst[i+3] = y3;
+      }
+      for (; i < frames; ++i) {
+        const float xn = src[i];
+        const float yn = ff0 * xn + z1;
+        z1 = ff1 * xn + z2 - fb1 * yn;
+        z2 = ff2 * xn - fb2 * yn;
+        dst[i] = yn;
+      }
+
+      mZ1[s] = z1;
+      mZ2[s] = z2;
+    }
+  };
+
+  /**
+   * Transposed form 2 Bi-Quad construct with linearly ramped coefficients.
+   *
+   * Target coefficients are computed once per block, e.g. with
+   * BiQuad::Coeffs::setSOLP(), and the active coefficients ramp to them over
+   * the given number of samples. This avoids both the per-sample cost of
+   * recomputing coefficients and the zipper noise of stepping them per block.
+   *
+   * @note Intermediate coefficients are not guaranteed to be stable. Keep
+   *       per-block changes moderate, e.g. at modulation rate.
+   */
+  struct SmoothBiQuad {
+
+    /*=====================================================================*/
+    /* Constructor / Destructor.                                           */
+    /*=====================================================================*/
+
+    /**
+     * Default constructor
+     */
+    SmoothBiQuad(void) : mZ1(0), mZ2(0), mRamp(0)
+    { }
+
+    /*=====================================================================*/
+    /* Public Methods.                                                     */
+    /*=====================================================================*/
+
+    /**
+     * Flush internal delays
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void flush(void) {
+      mZ1 = mZ2 = 0;
+    }
+
+    /**
+     * Set coefficients immediately, cancelling any ramp in progress
+     *
+     * @param c  Coefficients
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void setCoeffs(const BiQuad::Coeffs & c) {
+      mCoeffs = mTarget = c;
+      mRamp = 0;
+    }
+
+    /**
+     * Ramp coefficients to new target values
+     *
+     * @param c  Target coefficients
+     * @param frames  Number of samples over which to ramp, typically the block size
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void setTarget(const BiQuad::Coeffs & c, const uint32_t frames) {
+      if (frames == 0) {
+        setCoeffs(c);
+        return;
+      }
+      const float r = 1.f / frames;
+      mDelta.ff0 = (c.ff0 - mCoeffs.ff0) * r;
+      mDelta.ff1 = (c.ff1 - mCoeffs.ff1) * r;
+      mDelta.ff2 = (c.ff2 - mCoeffs.ff2) * r;
+      mDelta.fb1 = (c.fb1 - mCoeffs.fb1) * r;
+      mDelta.fb2 = (c.fb2 - mCoeffs.fb2) * r;
+      mTarget = c;
+      mRamp = frames;
+    }
+
+    /**
+     * Second order processing of a buffer
+     *
+     * @param x  Input buffer
+     * @param y  Output buffer, may be the same as input buffer
+     * @param frames  Size of buffers
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void process(const float * x, float * y, const uint32_t frames) {
+      float ff0 = mCoeffs.ff0, ff1 = mCoeffs.ff1, ff2 = mCoeffs.ff2;
+      float fb1 = mCoeffs.fb1, fb2 = mCoeffs.fb2;
+      float z1 = mZ1, z2 = mZ2;
+
+      uint32_t i = 0;
+      if (mRamp) {
+        const uint32_t ramp = (mRamp < frames) ? mRamp : frames;
+        const float dff0 = mDelta.ff0, dff1 = mDelta.ff1, dff2 = mDelta.ff2;
+        const float dfb1 = mDelta.fb1, dfb2 = mDelta.fb2;
+        for (; i < ramp; ++i) {
+          ff0 += dff0; ff1 += dff1; ff2 += dff2;
+          fb1 += dfb1; fb2 += dfb2;
+          const float xn = x[i];
+          const float yn = ff0 * xn + z1;
+          z1 = ff1 * xn + z2 - fb1 * yn;
+          z2 = ff2 * xn - fb2 * yn;
+          y[i] = yn;
+        }
+        mRamp -= ramp;
+        if (mRamp == 0) {
+          // Note: snap to target to avoid accumulating rounding errors
+          ff0 = mTarget.ff0; ff1 = mTarget.ff1; ff2 = mTarget.ff2;
+          fb1 = mTarget.fb1; fb2 = mTarget.fb2;
+        }
+        mCoeffs.ff0 = ff0; mCoeffs.ff1 = ff1; mCoeffs.ff2 = ff2;
+        mCoeffs.fb1 = fb1; mCoeffs.fb2 = fb2;
+      }
+
+      for (; i < frames; ++i) {
+        const float xn = x[i];
+        const float yn = ff0 * xn + z1;
+        z1 = ff1 * xn + z2 - fb1 * yn;
+        z2 = ff2 * xn - fb2 * yn;
+        y[i] = yn;
+      }
+
+      mZ1 = z1;
+      mZ2 = z2;
+    }
+
+    /**
+     * Second order processing of one sample
+     *
+     * @param xn  Input sample
+     *
+     * @return Output sample
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    float process(const float xn) {
+      float y;
+      process(&xn, &y, 1);
+      return y;
+    }
+
+    /*=====================================================================*/
+    /* Member Variables.                                                   */
+    /*=====================================================================*/
+
+    /** Active, target and per-sample increment coefficients */
+    BiQuad::Coeffs mCoeffs, mTarget, mDelta;
+    float mZ1, mZ2;
+    /** Remaining ramp samples */
+    uint32_t mRamp;
+  };
 }
 
 /** @} */
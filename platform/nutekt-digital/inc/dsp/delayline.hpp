@@ -50,6 +50,66 @@
  */
 namespace dsp {
 
+  /**
+   * Fractional delay interpolation modes, see DelayLine::readInterp().
+   */
+  enum DelayInterp {
+    k_delay_interp_linear = 0,  /**< 2-point linear, same as readFrac() */
+    k_delay_interp_hermite,     /**< 4-point 3rd order Hermite (Catmull-Rom) */
+    k_delay_interp_lagrange3,   /**< 4-point 3rd order Lagrange */
+    k_delay_interp_allpass      /**< 1st order allpass, stateful, one modulated tap per line */
+  };
+
+  /**
+   * Weights of a 4-point interpolator for the samples at offsets pos-1, pos, pos+1 and pos+2.
+   *
+   * @param f Fractional part of the position
+   * @param w Destination for the 4 weights
+   */
+  template<DelayInterp I>
+  inline __attribute__((optimize("Ofast"),always_inline))
+  void delay_interp_weights(const float f, float * w) {
+    if (I == k_delay_interp_hermite) {
+      const float f2 = f * f;
+      const float f3 = f2 * f;
+      w[0] = 0.5f * (-f3 + 2.f * f2 - f);
+      w[1] = 0.5f * (3.f * f3 - 5.f * f2) + 1.f;
+      w[2] = 0.5f * (-3.f * f3 + 4.f * f2 + f);
+      w[3] = 0.5f * (f3 - f2);
+    }
+    else if (I == k_delay_interp_lagrange3) {
+      const float fp1 = f + 1.f;
+      const float fm1 = f - 1.f;
+      const float fm2 = f - 2.f;
+      w[0] = -f * fm1 * fm2 * (1.f / 6.f);
+      w[1] = fp1 * fm1 * fm2 * 0.5f;
+      w[2] = -fp1 * f * fm2 * 0.5f;
+      w[3] = fp1 * f * fm1 * (1.f / 6.f);
+    }
+    else {
+      w[0] = w[3] = 0.f;
+      w[1] = 1.f - f;
+      w[2] = f;
+    }
+  }
+
+  /**
+   * Allpass interpolator coefficient for a fractional position.
+   *
+   * @param base Integer part of the position, adjusted so that the fractional delay is in [0.5, 1.5)
+   * @param frac Fractional part of the position
+   * @return Allpass coefficient, in (-0.2, 0.34]
+   */
+  inline __attribute__((optimize("Ofast"),always_inline))
+  float delay_interp_allpass_coeff(uint32_t &base, float frac) {
+    // Note: keeps the pole away from -1, where the allpass rings at Nyquist
+    if (frac < 0.5f) {
+      --base;
+      frac += 1.f;
+    }
+    return (1.f - frac) / (1.f + frac);
+  }
+
   /**
    * Basic delay line abstraction.
    */
@@ -69,6 +129,7 @@ namespace dsp {
     DelayLine(void) :
       mLine(0),
       mFracZ(0),
+      mApZ(0),
       mSize(0),
       mMask(0),
       mWriteIdx(0)
@@ -84,6 +145,7 @@ namespace dsp {
     DelayLine(float *ram, size_t line_size) :
       mLine(ram),
       mFracZ(0),
+      mApZ(0),
       mSize(line_size),
       mMask(line_size-1),
       mWriteIdx(0)
@@ -167,6 +229,156 @@ namespace dsp {
       mFracZ = s0;
       return y;
     }
+
+    /**
+     * Write a block of samples to the head of the delay line.
+     *
+     * Equivalent to calling write() for each sample in order.
+     *
+     * @param src Samples to write
+     * @param frames Number of samples
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void writeBlock(const float * __restrict__ src, uint32_t frames) {
+      // Note: samples are stored at decreasing indices, copy in at most two segments split at index 0
+      uint32_t idx = mWriteIdx & mMask;
+      mWriteIdx -= frames;
+      while (frames) {
+        const uint32_t seg = (frames < idx + 1) ? frames : idx + 1;
+        float * __restrict__ dst = mLine + idx;
+        for (const float * src_e = src + seg; src != src_e; )
+          *(dst--) = *(src++);
+        frames -= seg;
+        idx = mMask;
+      }
+    }
+
+    /**
+     * Read a block of samples at a fixed position, following a writeBlock() of the same size.
+     *
+     * dst[i] is the sample read(pos) would have returned right after write() of the i-th sample of the block.
+     *
+     * @param dst Destination buffer
+     * @param pos Offset from write index, pos + frames must not exceed the line size
+     * @param frames Number of samples
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void readBlock(float * __restrict__ dst, const uint32_t pos, uint32_t frames) {
+      uint32_t idx = (mWriteIdx + frames - 1 + pos) & mMask;
+      while (frames) {
+        const uint32_t seg = (frames < idx + 1) ? frames : idx + 1;
+        const float * __restrict__ src = mLine + idx;
+        for (const float * dst_e = dst + seg; dst != dst_e; )
+          *(dst++) = *(src--);
+        frames -= seg;
+        idx = mMask;
+      }
+    }
+
+    /**
+     * Read a block of linearly interpolated samples at a fixed fractional position, following a writeBlock() of the same size.
+     *
+     * dst[i] is the sample readFrac(pos) would have returned right after write() of the i-th sample of the block.
+     *
+     * @param dst Destination buffer
+     * @param pos Offset from write index as floating point, pos + frames + 1 must not exceed the line size
+     * @param frames Number of samples
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void readFracBlock(float * __restrict__ dst, const float pos, uint32_t frames) {
+      const uint32_t base = (uint32_t)pos;
+      const float frac = pos - base;
+      uint32_t idx = (mWriteIdx + frames - 1 + base) & mMask;
+      // Note: consecutive outputs step down by one sample, so s1 of each output is s0 of the previous one
+      float s1 = mLine[(idx + 1) & mMask];
+      while (frames) {
+        const uint32_t seg = (frames < idx + 1) ? frames : idx + 1;
+        const float * __restrict__ src = mLine + idx;
+        for (const float * dst_e = dst + seg; dst != dst_e; ) {
+          const float s0 = *(src--);
+          *(dst++) = linintf(frac, s0, s1);
+          s1 = s0;
+        }
+        frames -= seg;
+        idx = mMask;
+      }
+    }
+
+    /**
+     * Read a sample from the delay line at a fractional position from current write index, with selectable interpolation.
+     *
+     * @tparam I Interpolation mode
+     * @param pos Offset from write index as floating point, at least 2 for modes other than linear.
+     * @return Interpolated sample at given fractional position from write index
+     */
+    template<DelayInterp I>
+    inline __attribute__((optimize("Ofast"),always_inline))
+    float readInterp(const float pos) {
+      if (I == k_delay_interp_linear)
+        return readFrac(pos);
+      uint32_t base = (uint32_t)pos;
+      const float frac = pos - base;
+      if (I == k_delay_interp_allpass) {
+        const float eta = delay_interp_allpass_coeff(base, frac);
+        mApZ = read(base+1) + eta * (read(base) - mApZ);
+        return mApZ;
+      }
+      float w[4];
+      delay_interp_weights<I>(frac, w);
+      return w[0] * read(base-1) + w[1] * read(base) + w[2] * read(base+1) + w[3] * read(base+2);
+    }
+
+    /**
+     * Read a block of interpolated samples at a fixed fractional position, following a writeBlock() of the same size.
+     *
+     * dst[i] is the sample readInterp<I>(pos) would have returned right after write() of the i-th sample of the block.
+     *
+     * @tparam I Interpolation mode
+     * @param dst Destination buffer
+     * @param pos Offset from write index as floating point, at least 2 for modes other than linear,
+     *            pos + frames + 2 must not exceed the line size
+     * @param frames Number of samples
+     */
+    template<DelayInterp I>
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void readInterpBlock(float * __restrict__ dst, const float pos, uint32_t frames) {
+      if (I == k_delay_interp_linear) {
+        readFracBlock(dst, pos, frames);
+        return;
+      }
+      uint32_t base = (uint32_t)pos;
+      const float frac = pos - base;
+      float w[4] = {0, 0, 0, 0};
+      float eta = 0;
+      if (I == k_delay_interp_allpass)
+        eta = delay_interp_allpass_coeff(base, frac);
+      else
+        delay_interp_weights<I>(frac, w);
+
+      // Note: the 4-point window slides down by one sample per output, only its newest sample is loaded
+      uint32_t idx = (mWriteIdx + frames - 2 + base) & mMask;
+      float x0 = mLine[(idx + 1) & mMask];
+      float x1 = mLine[(idx + 2) & mMask];
+      float x2 = mLine[(idx + 3) & mMask];
+      float z = mApZ;
+      while (frames) {
+        const uint32_t seg = (frames < idx + 1) ? frames : idx + 1;
+        const float * __restrict__ src = mLine + idx;
+        for (const float * dst_e = dst + seg; dst != dst_e; ) {
+          const float xm1 = *(src--);
+          if (I == k_delay_interp_allpass)
+            *(dst++) = z = x1 + eta * (x0 - z);
+          else
+            *(dst++) = w[0] * xm1 + w[1] * x0 + w[2] * x1 + w[3] * x2;
+          x2 = x1;
+          x1 = x0;
+          x0 = xm1;
+        }
+        frames -= seg;
+        idx = mMask;
+      }
+      mApZ = z;
+    }
       
       
     /*===========================================================================*/
@@ -175,6 +387,7 @@ namespace dsp {
       
     float   *mLine;
     float    mFracZ;
+    float    mApZ;
     size_t   mSize;
     size_t   mMask;
     uint32_t mWriteIdx;
@@ -199,6 +412,8 @@ namespace dsp {
      */
     DualDelayLine(void) :
       mLine(0),
+      mFracZ(f32pair(0, 0)),
+      mApZ(f32pair(0, 0)),
       mSize(0),
       mMask(0),
       mWriteIdx(0)
@@ -213,6 +428,8 @@ namespace dsp {
      *
      */
     DualDelayLine(f32pair_t *ram, size_t line_size) :
+      mFracZ(f32pair(0, 0)),
+      mApZ(f32pair(0, 0)),
       mWriteIdx(0)
     {
       setMemory(ram, line_size);
@@ -379,6 +596,113 @@ namespace dsp {
       mFracZ.b = f0;
       return y;
     }
+
+    /**
+     * Write a block of sample pairs, equivalent to calling write() for each pair in order.
+     *
+     * @param src Sample pairs to write
+     * @param frames Number of sample pairs
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void writeBlock(const f32pair_t * __restrict__ src, uint32_t frames) {
+      // Note: pairs are stored at decreasing indices, copy in at most two segments split at index 0
+      uint32_t idx = mWriteIdx & mMask;
+      mWriteIdx -= frames;
+      while (frames) {
+        const uint32_t seg = (frames < idx + 1) ? frames : idx + 1;
+        f32pair_t * __restrict__ dst = mLine + idx;
+        for (const f32pair_t * src_e = src + seg; src != src_e; )
+          *(dst--) = *(src++);
+        frames -= seg;
+        idx = mMask;
+      }
+    }
+
+    /**
+     * Read a sample pair from the delay line at a fractional position from current write index, with selectable interpolation.
+     *
+     * @tparam I Interpolation mode
+     * @param pos Offset from write index as floating point, at least 2 for modes other than linear.
+     * @return Interpolated sample pair at given fractional position from write index
+     */
+    template<DelayInterp I>
+    inline __attribute__((optimize("Ofast"),always_inline))
+    f32pair_t readInterp(const float pos) {
+      if (I == k_delay_interp_linear)
+        return readFrac(pos);
+      uint32_t base = (uint32_t)pos;
+      const float frac = pos - base;
+      if (I == k_delay_interp_allpass) {
+        const float eta = delay_interp_allpass_coeff(base, frac);
+        const f32pair_t p0 = read(base);
+        const f32pair_t p1 = read(base+1);
+        mApZ.a = p1.a + eta * (p0.a - mApZ.a);
+        mApZ.b = p1.b + eta * (p0.b - mApZ.b);
+        return mApZ;
+      }
+      float w[4];
+      delay_interp_weights<I>(frac, w);
+      const f32pair_t pm1 = read(base-1);
+      const f32pair_t p0 = read(base);
+      const f32pair_t p1 = read(base+1);
+      const f32pair_t p2 = read(base+2);
+      return (f32pair_t){ w[0] * pm1.a + w[1] * p0.a + w[2] * p1.a + w[3] * p2.a,
+                          w[0] * pm1.b + w[1] * p0.b + w[2] * p1.b + w[3] * p2.b };
+    }
+
+    /**
+     * Read a block of interpolated sample pairs at a fixed fractional position, following a writeBlock() of the same size.
+     *
+     * dst[i] is the pair readInterp<I>(pos) would have returned right after write() of the i-th pair of the block.
+     *
+     * @tparam I Interpolation mode
+     * @param dst Destination buffer
+     * @param pos Offset from write index as floating point, at least 2 for modes other than linear,
+     *            pos + frames + 2 must not exceed the line size
+     * @param frames Number of sample pairs
+     */
+    template<DelayInterp I>
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void readInterpBlock(f32pair_t * __restrict__ dst, const float pos, uint32_t frames) {
+      uint32_t base = (uint32_t)pos;
+      const float frac = pos - base;
+      float w[4] = {0, 0, 0, 0};
+      float eta = 0;
+      if (I == k_delay_interp_allpass)
+        eta = delay_interp_allpass_coeff(base, frac);
+      else if (I != k_delay_interp_linear)
+        delay_interp_weights<I>(frac, w);
+
+      // Note: the 4-point window slides down by one pair per output, only its newest pair is loaded
+      uint32_t idx = (mWriteIdx + frames - 2 + base) & mMask;
+      f32pair_t x0 = mLine[(idx + 1) & mMask];
+      f32pair_t x1 = mLine[(idx + 2) & mMask];
+      f32pair_t x2 = mLine[(idx + 3) & mMask];
+      f32pair_t z = mApZ;
+      while (frames) {
+        const uint32_t seg = (frames < idx + 1) ? frames : idx + 1;
+        const f32pair_t * __restrict__ src = mLine + idx;
+        for (const f32pair_t * dst_e = dst + seg; dst != dst_e; ) {
+          const f32pair_t xm1 = *(src--);
+          if (I == k_delay_interp_linear)
+            *(dst++) = f32pair_linint(frac, x0, x1);
+          else if (I == k_delay_interp_allpass) {
+            z.a = x1.a + eta * (x0.a - z.a);
+            z.b = x1.b + eta * (x0.b - z.b);
+            *(dst++) = z;
+          }
+          else
+            *(dst++) = (f32pair_t){ w[0] * xm1.a + w[1] * x0.a + w[2] * x1.a + w[3] * x2.a,
+                                    w[0] * xm1.b + w[1] * x0.b + w[2] * x1.b + w[3] * x2.b };
+          x2 = x1;
+          x1 = x0;
+          x0 = xm1;
+        }
+        frames -= seg;
+        idx = mMask;
+      }
+      mApZ = z;
+    }
       
     /*===========================================================================*/
     /* Member Variables.                                                         */
@@ -386,6 +710,7 @@ namespace dsp {
       
     f32pair_t *mLine;
     f32pair_t  mFracZ;
+    f32pair_t  mApZ;
     size_t     mSize;
     size_t     mMask;
     uint32_t   mWriteIdx;
@@ -0,0 +1,266 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    osc_api.c
+ * @brief   Host implementation of the oscillator runtime API (ld/osc_api.syms).
+ *
+ * Provides every symbol that oscillator units resolve against the firmware
+ * with --just-symbols. Inline API functions of osc_api.h are compiled from
+ * the SDK header itself, only the firmware side is emulated here.
+ *
+ * @note The firmware tables are not distributed with the SDK. Tables are
+ *       regenerated from their documented definitions: analytic tables match
+ *       to float rounding, band-limited and wave bank contents are stand-ins
+ *       with the documented layout, symmetry and harmonic ordering.
+ */
+
+#include "userprg.h"
+
+#include <math.h>
+
+#include "api_luts.h"
+
+/* Note: sizes mirror osc_api.h, which cannot be included here (see api_luts.h) */
+#define k_midi_to_hz_size  (152)
+#define k_wt_lut_size      (129)
+#define k_wt_notes_cnt     (7)
+#define k_wt_max_harmonics (127)
+#define k_waves_lut_size   (129)
+#define k_waves_banks_cnt  (6)
+#define k_waves_max_cnt    (16)
+
+/*===========================================================================*/
+/* Runtime Environment.                                                      */
+/*===========================================================================*/
+
+const uint32_t k_osc_api_platform = USER_TARGET_PLATFORM;
+const uint32_t k_osc_api_version = USER_API_VERSION;
+
+uint32_t _osc_mcu_hash(void) {
+  return host_mcu_hash();
+}
+
+/*===========================================================================*/
+/* Lookup Tables.                                                            */
+/*===========================================================================*/
+
+float midi_to_hz_lut_f[k_midi_to_hz_size];
+
+// Note: notes at which each band-limited table stops being alias-free
+uint8_t wt_saw_notes[k_wt_notes_cnt] = {60, 72, 84, 96, 108, 120, 132};
+uint8_t wt_sqr_notes[k_wt_notes_cnt] = {60, 72, 84, 96, 108, 120, 132};
+uint8_t wt_par_notes[k_wt_notes_cnt] = {60, 72, 84, 96, 108, 120, 132};
+
+// Note: one extra table so that the interpolated lookups read a valid (zero weighted) table at index 6
+float wt_saw_lut_f[(k_wt_notes_cnt + 1) * k_wt_lut_size];
+float wt_sqr_lut_f[(k_wt_notes_cnt + 1) * k_wt_lut_size];
+float wt_par_lut_f[(k_wt_notes_cnt + 1) * k_wt_lut_size];
+
+/*===========================================================================*/
+/* Waves.                                                                    */
+/*===========================================================================*/
+
+static const uint8_t s_waves_cnt[k_waves_banks_cnt] = {16, 16, 14, 13, 15, 16};
+
+static float s_waves_data[k_waves_banks_cnt][k_waves_max_cnt][k_waves_lut_size];
+
+const float * wavesA[k_waves_max_cnt];
+const float * wavesB[k_waves_max_cnt];
+const float * wavesC[k_waves_max_cnt];
+const float * wavesD[k_waves_max_cnt];
+const float * wavesE[k_waves_max_cnt];
+const float * wavesF[k_waves_max_cnt];
+
+static const float ** const s_waves_banks[k_waves_banks_cnt] = {
+  wavesA, wavesB, wavesC, wavesD, wavesE, wavesF
+};
+
+/*===========================================================================*/
+/* Table Generation.                                                         */
+/*===========================================================================*/
+
+typedef enum {
+  k_bl_saw = 0,
+  k_bl_sqr,
+  k_bl_par
+} bl_wave_t;
+
+static double note_to_hz(double note) {
+  return 440.0 * pow(2.0, (note - 69.0) / 12.0);
+}
+
+/*
+ * Fill one band-limited table: phase 0 to 0.5 over k_wt_lut_size points,
+ * with harmonics kept below Nyquist up to the given note.
+ */
+static void bl_table_init(float * lut, bl_wave_t type, uint8_t max_note) {
+  int harmonics = (int)(24000.0 / note_to_hz(max_note));
+  if (harmonics < 1)
+    harmonics = 1;
+  if (harmonics > k_wt_max_harmonics)
+    harmonics = k_wt_max_harmonics;
+
+  for (int i = 0; i < k_wt_lut_size; ++i) {
+    const double p = (double)i / (2 * (k_wt_lut_size - 1));
+    double y = 0;
+    for (int k = 1; k <= harmonics; ++k) {
+      switch (type) {
+      case k_bl_saw:
+        y += sin(2 * M_PI * k * p) / k;
+        break;
+      case k_bl_sqr:
+        if (k & 1)
+          y += sin(2 * M_PI * k * p) / k;
+        break;
+      case k_bl_par:
+        y += cos(2 * M_PI * k * p) / ((double)k * k);
+        break;
+      }
+    }
+    switch (type) {
+    case k_bl_saw:
+      lut[i] = (float)(y * 2.0 / M_PI);
+      break;
+    case k_bl_sqr:
+      lut[i] = (float)(y * 4.0 / M_PI);
+      break;
+    case k_bl_par:
+      lut[i] = (float)(y * 6.0 / (M_PI * M_PI));
+      break;
+    }
+  }
+}
+
+static void bl_tables_init(float * luts, const uint8_t * notes, bl_wave_t type) {
+  for (int t = 0; t < k_wt_notes_cnt; ++t)
+    bl_table_init(&luts[t * k_wt_lut_size], type, notes[t]);
+  // Padding table, see declaration
+  for (int i = 0; i < k_wt_lut_size; ++i)
+    luts[k_wt_notes_cnt * k_wt_lut_size + i] = luts[(k_wt_notes_cnt - 1) * k_wt_lut_size + i];
+}
+
+/*
+ * Fill a single cycle wave: bank index raises harmonic count and flattens
+ * the spectral tilt, wave index walks through the bank.
+ */
+static void wave_init(float * w, uint32_t bank, uint32_t idx, uint32_t cnt) {
+  static const uint8_t k_bank_harmonics[k_waves_banks_cnt] = {4, 8, 16, 24, 40, 63};
+  const int harmonics = 1 + (int)((k_bank_harmonics[bank] - 1) * idx / (cnt - 1));
+  const double tilt = 2.0 - 0.25 * bank;
+
+  uint32_t seed = 1 + bank * k_waves_max_cnt + idx;
+  double amp[64], phase[64];
+  for (int k = 1; k <= harmonics; ++k) {
+    seed = seed * 1664525U + 1013904223U;
+    amp[k] = (0.25 + 0.75 * (seed >> 8) / 16777216.0) / pow(k, tilt);
+    phase[k] = (seed & 1) ? 0.0 : M_PI * 0.5;
+  }
+  amp[1] = 1.0;
+  phase[1] = 0.0;
+
+  double peak = 0;
+  double buf[k_waves_lut_size];
+  for (int i = 0; i < k_waves_lut_size - 1; ++i) {
+    const double p = (double)i / (k_waves_lut_size - 1);
+    double y = 0;
+    for (int k = 1; k <= harmonics; ++k)
+      y += amp[k] * sin(2 * M_PI * k * p + phase[k]);
+    buf[i] = y;
+    peak = (fabs(y) > peak) ? fabs(y) : peak;
+  }
+  buf[k_waves_lut_size - 1] = buf[0];
+
+  for (int i = 0; i < k_waves_lut_size; ++i)
+    w[i] = (float)(buf[i] / peak);
+}
+
+__attribute__((constructor(101)))
+static void osc_api_init(void) {
+  host_luts_init();
+
+  for (int n = 0; n < k_midi_to_hz_size; ++n)
+    midi_to_hz_lut_f[n] = (float)note_to_hz(n);
+
+  bl_tables_init(wt_saw_lut_f, wt_saw_notes, k_bl_saw);
+  bl_tables_init(wt_sqr_lut_f, wt_sqr_notes, k_bl_sqr);
+  bl_tables_init(wt_par_lut_f, wt_par_notes, k_bl_par);
+
+  for (uint32_t b = 0; b < k_waves_banks_cnt; ++b) {
+    for (uint32_t i = 0; i < s_waves_cnt[b]; ++i) {
+      wave_init(s_waves_data[b][i], b, i, s_waves_cnt[b]);
+      s_waves_banks[b][i] = s_waves_data[b][i];
+    }
+  }
+}
+
+/*===========================================================================*/
+/* Band-limited Wave Index.                                                  */
+/*===========================================================================*/
+
+/*
+ * Fractional table index for note: table t is alias-free up to notes[t], so
+ * between notes[t-1] and notes[t] tables t and t+1 are both safe to blend.
+ */
+static float bl_idx(const uint8_t * notes, float note) {
+  int t = 0;
+  while (t < k_wt_notes_cnt - 1 && note > notes[t])
+    ++t;
+  const float n0 = (t > 0) ? notes[t - 1] : 2.f * notes[0] - notes[1];
+  const float idx = t + (note - n0) / (notes[t] - n0);
+  return (idx < 0.f) ? 0.f : (idx > k_wt_notes_cnt - 1) ? (float)(k_wt_notes_cnt - 1) : idx;
+}
+
+float _osc_bl_saw_idx(float note) {
+  return bl_idx(wt_saw_notes, note);
+}
+
+float _osc_bl_sqr_idx(float note) {
+  return bl_idx(wt_sqr_notes, note);
+}
+
+float _osc_bl_par_idx(float note) {
+  return bl_idx(wt_par_notes, note);
+}
+
+/*===========================================================================*/
+/* Noise Source.                                                             */
+/*===========================================================================*/
+
+uint32_t _osc_rand(void) {
+  return host_rand();
+}
+
+float _osc_white(void) {
+  return host_white();
+}
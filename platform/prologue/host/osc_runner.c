@@ -0,0 +1,341 @@
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    osc_runner.c
+ * @brief   Offline host runner for user oscillators.
+ *
+ * Loads a unit built as a native shared object against the emulated
+ * runtime (osc_api.c) and drives its hooks the way the firmware does:
+ * _entry(), parameter changes, _hook_on(), then _hook_cycle() per buffer of
+ * up to 64 frames of q31 output, and _hook_off() at the end of the gate.
+ */
+
+#include <dlfcn.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "userosc.h"
+
+#include "bench.h"
+#include "sdram_check.h"
+#include "wav_file.h"
+
+#define k_max_frames_per_buffer (64)
+#define k_max_param_settings    (32)
+
+/*===========================================================================*/
+/* Unit Hooks.                                                               */
+/*===========================================================================*/
+
+typedef struct osc_unit {
+  void *           handle;
+  UserOscFuncEntry entry;
+  UserOscFuncCycle cycle;
+  UserOscFuncOn    on;
+  UserOscFuncOff   off;
+  UserOscFuncMute  mute;
+  UserOscFuncValue value;
+  UserOscFuncParam param;
+} osc_unit_t;
+
+static int unit_load(osc_unit_t * unit, const char * path) {
+  memset(unit, 0, sizeof(*unit));
+  unit->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (!unit->handle) {
+    fprintf(stderr, "error: %s\n", dlerror());
+    return -1;
+  }
+
+  // Note: tpl/_unit.c provides weak defaults, all hooks are expected to resolve
+  struct {
+    const char * name;
+    void ** fptr;
+  } syms[] = {
+    {"_entry", (void **)&unit->entry},
+    {"_hook_cycle", (void **)&unit->cycle},
+    {"_hook_on", (void **)&unit->on},
+    {"_hook_off", (void **)&unit->off},
+    {"_hook_mute", (void **)&unit->mute},
+    {"_hook_value", (void **)&unit->value},
+    {"_hook_param", (void **)&unit->param},
+  };
+
+  for (size_t i = 0; i < sizeof(syms) / sizeof(syms[0]); ++i) {
+    *syms[i].fptr = dlsym(unit->handle, syms[i].name);
+    if (!*syms[i].fptr) {
+      fprintf(stderr, "error: %s: missing symbol %s\n", path, syms[i].name);
+      dlclose(unit->handle);
+      unit->handle = NULL;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/*===========================================================================*/
+/* Options.                                                                  */
+/*===========================================================================*/
+
+typedef struct param_setting {
+  uint16_t index;
+  uint16_t value;
+} param_setting_t;
+
+typedef struct options {
+  const char *    unit_path;
+  const char *    output_path;
+  uint16_t        output_bits;
+  uint32_t        frames_per_buffer;
+  float           duration;
+  float           gate;
+  uint8_t         note;
+  uint8_t         fine;
+  float           shape_lfo;
+  size_t          bench_calls;
+  const char *    bench_label;
+  size_t          param_count;
+  param_setting_t params[k_max_param_settings];
+} options_t;
+
+static void usage(const char * argv0) {
+  fprintf(stderr,
+          "Usage: %s [options] <unit.so>\n"
+          "\n"
+          "  -o FILE          Output WAV file (mono)\n"
+          "  -b BITS          Output bit depth: 16 or 32 (float, default)\n"
+          "  -f FRAMES        Frames per buffer, 1 to 64 (default: 64)\n"
+          "  -d SECONDS       Render duration (default: 2)\n"
+          "  -n NOTE[:FINE]   Note and fine pitch (0-255) (default: 60:0)\n"
+          "  -g SECONDS       Gate length before note off (default: 1)\n"
+          "  -p INDEX=VALUE   Set parameter after initialization (repeatable)\n"
+          "                   INDEX 0-5: edit parameters 1-6, 6: shape, 7: shift-shape (10-bit)\n"
+          "  -l VALUE         Shape LFO value in [-1.0, 1.0] (default: 0)\n"
+          "  -B CALLS         Benchmark mode: time CALLS _hook_cycle calls, no WAV output\n"
+          "  -L LABEL         Label printed with benchmark results (default: unit file name)\n",
+          argv0);
+}
+
+static int parse_options(int argc, char ** argv, options_t * o) {
+  memset(o, 0, sizeof(*o));
+  o->output_bits = 32;
+  o->frames_per_buffer = k_max_frames_per_buffer;
+  o->duration = 2.f;
+  o->gate = 1.f;
+  o->note = 60;
+
+  int c;
+  while ((c = getopt(argc, argv, "o:b:f:d:n:g:p:l:B:L:h")) != -1) {
+    switch (c) {
+    case 'o':
+      o->output_path = optarg;
+      break;
+    case 'b':
+      o->output_bits = atoi(optarg);
+      break;
+    case 'f':
+      o->frames_per_buffer = atoi(optarg);
+      break;
+    case 'd':
+      o->duration = atof(optarg);
+      break;
+    case 'n': {
+      unsigned note = 60, fine = 0;
+      if (sscanf(optarg, "%u:%u", &note, &fine) < 1 || note > 151 || fine > 255) {
+        fprintf(stderr, "error: invalid note: %s\n", optarg);
+        return -1;
+      }
+      o->note = note;
+      o->fine = fine;
+    } break;
+    case 'g':
+      o->gate = atof(optarg);
+      break;
+    case 'p': {
+      unsigned index, value;
+      if (o->param_count == k_max_param_settings || sscanf(optarg, "%u=%u", &index, &value) != 2
+          || index >= k_num_user_osc_param_id) {
+        fprintf(stderr, "error: invalid parameter setting: %s\n", optarg);
+        return -1;
+      }
+      o->params[o->param_count].index = index;
+      o->params[o->param_count].value = value;
+      ++o->param_count;
+    } break;
+    case 'l':
+      o->shape_lfo = atof(optarg);
+      break;
+    case 'B':
+      o->bench_calls = strtoul(optarg, NULL, 10);
+      break;
+    case 'L':
+      o->bench_label = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return -1;
+    }
+  }
+
+  if (optind != argc - 1) {
+    usage(argv[0]);
+    return -1;
+  }
+  o->unit_path = argv[optind];
+
+  if (o->frames_per_buffer < 1 || o->frames_per_buffer > k_max_frames_per_buffer) {
+    fprintf(stderr, "error: frames per buffer must be in [1, %u]\n", k_max_frames_per_buffer);
+    return -1;
+  }
+  if (!o->bench_label) {
+    const char * slash = strrchr(o->unit_path, '/');
+    o->bench_label = slash ? slash + 1 : o->unit_path;
+  }
+  return 0;
+}
+
+/*===========================================================================*/
+/* Rendering.                                                                */
+/*===========================================================================*/
+
+static void unit_start(const options_t * o, const osc_unit_t * unit, user_osc_param_t * params) {
+  memset(params, 0, sizeof(*params));
+  params->shape_lfo = f32_to_q31(clip1m1f(o->shape_lfo));
+  params->pitch = (o->note << 8) | o->fine;
+  params->cutoff = 0x1FFF;
+  params->resonance = 0;
+
+  unit->entry(USER_TARGET_PLATFORM | k_user_module_osc, USER_API_VERSION);
+  for (size_t i = 0; i < o->param_count; ++i)
+    unit->param(o->params[i].index, o->params[i].value);
+}
+
+static int render(const options_t * o, const osc_unit_t * unit) {
+  const size_t total = (size_t)(o->duration * k_samplerate);
+  const size_t gate = (size_t)(o->gate * k_samplerate);
+
+  wav_file_t wav;
+  if (wav_alloc(&wav, k_samplerate, 1, total)) {
+    fprintf(stderr, "error: out of memory\n");
+    return -1;
+  }
+
+  user_osc_param_t params;
+  unit_start(o, unit, &params);
+  unit->on(&params);
+
+  int32_t buf[k_max_frames_per_buffer];
+  int gated = 1;
+  for (size_t pos = 0; pos < total;) {
+    uint32_t frames = o->frames_per_buffer;
+    if (frames > total - pos)
+      frames = total - pos;
+    // Note: split buffers at the end of the gate so that note off is sample accurate
+    if (gated && pos < gate && pos + frames > gate)
+      frames = gate - pos;
+    if (gated && pos >= gate) {
+      unit->off(&params);
+      gated = 0;
+    }
+
+    unit->cycle(&params, buf, frames);
+    for (uint32_t i = 0; i < frames; ++i)
+      wav.samples[pos + i] = q31_to_f32(buf[i]);
+    pos += frames;
+  }
+
+  int err = 0;
+  if (o->output_path)
+    err = wav_write(&wav, o->output_path, o->output_bits);
+  if (!err)
+    printf("rendered %zu frames (%.3f s) in buffers of %u frames, note %u:%u\n", total,
+           (double)total / k_samplerate, o->frames_per_buffer, o->note, o->fine);
+  wav_free(&wav);
+  return err;
+}
+
+static int benchmark(const options_t * o, const osc_unit_t * unit) {
+  uint64_t * samples_ns = (uint64_t *)malloc(o->bench_calls * sizeof(uint64_t));
+  if (!samples_ns) {
+    fprintf(stderr, "error: out of memory\n");
+    return -1;
+  }
+
+  user_osc_param_t params;
+  unit_start(o, unit, &params);
+  unit->on(&params);
+
+  int32_t buf[k_max_frames_per_buffer];
+
+  // Note: warm up caches and branch predictors before measuring
+  const size_t warmup = (o->bench_calls / 10 > 16) ? o->bench_calls / 10 : 16;
+  for (size_t i = 0; i < warmup; ++i)
+    unit->cycle(&params, buf, o->frames_per_buffer);
+
+  for (size_t i = 0; i < o->bench_calls; ++i) {
+    const uint64_t t0 = bench_now();
+    unit->cycle(&params, buf, o->frames_per_buffer);
+    samples_ns[i] = bench_now() - t0;
+  }
+
+  unit->off(&params);
+
+  bench_stats_t stats;
+  bench_compute(samples_ns, o->bench_calls, k_samplerate, o->frames_per_buffer, &stats);
+  bench_print(o->bench_label, o->frames_per_buffer, &stats);
+  free(samples_ns);
+  return 0;
+}
+
+int main(int argc, char ** argv) {
+  options_t opt;
+  if (parse_options(argc, argv, &opt))
+    return EXIT_FAILURE;
+
+  osc_unit_t unit;
+  if (unit_load(&unit, opt.unit_path))
+    return EXIT_FAILURE;
+
+  // Note: oscillators have no SDRAM region, refuse to run units that would not link on the target
+  if (sdram_check(opt.unit_path, 0, NULL)) {
+    dlclose(unit.handle);
+    return EXIT_FAILURE;
+  }
+
+  const int err = (opt.bench_calls > 0) ? benchmark(&opt, &unit) : render(&opt, &unit);
+
+  dlclose(unit.handle);
+  return err ? EXIT_FAILURE : EXIT_SUCCESS;
+}
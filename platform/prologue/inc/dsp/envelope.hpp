@@ -0,0 +1,335 @@
+#pragma once
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    envelope.hpp
+ * @brief   ADSR envelope generator rendering whole blocks.
+ *
+ * @addtogroup dsp DSP
+ * @{
+ *
+ */
+
+#include "float_math.h"
+
+/**
+ * Common DSP Utilities
+ */
+namespace dsp {
+
+  /**
+   * Envelope stages.
+   */
+  enum AdsrStage {
+    k_adsr_idle = 0,
+    k_adsr_attack,
+    k_adsr_decay,
+    k_adsr_sustain,
+    k_adsr_release
+  };
+
+  /**
+   * ADSR envelope generator.
+   *
+   * Every stage is an exponential segment y[n] = target + (y[0] - target) * mult^n
+   * approaching a target set beyond the stage end level, so that its length
+   * is known in closed form when the stage starts. Attack aims above 1 for the
+   * familiar convex analog shape, decay and release aim slightly below their
+   * end levels, sustain and idle are constant.
+   *
+   * process() renders a block as a few segments, branching only where a stage
+   * ends. Gates restart the attack from the current level, so retriggers do
+   * not click.
+   */
+  struct Adsr {
+
+    /*=====================================================================*/
+    /* Constructor / Destructor.                                           */
+    /*=====================================================================*/
+
+    /**
+     * Default constructor, stages are instantaneous until times are set
+     */
+    Adsr(void) :
+      mAttackMult(k_attack_overshoot / (1.f + k_attack_overshoot)),
+      mDecayMult(k_decay_undershoot / (1.f + k_decay_undershoot)),
+      mReleaseMult(k_decay_undershoot / (1.f + k_decay_undershoot)),
+      mSustain(1.f)
+    {
+      reset();
+    }
+
+    /*=====================================================================*/
+    /* Public Methods.                                                     */
+    /*=====================================================================*/
+
+    /**
+     * Return to idle at level 0
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void reset(void) {
+      enter(k_adsr_idle, 0.f);
+    }
+
+    /**
+     * Set attack time
+     *
+     * @param seconds  Duration of a full scale attack, from 0 to 1
+     * @param fsrecip  Reciprocal of sampling frequency (1/Fs)
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void setAttack(const float seconds, const float fsrecip) {
+      mAttackMult = multiplier(seconds, fsrecip, k_attack_overshoot);
+      refresh();
+    }
+
+    /**
+     * Set decay time
+     *
+     * @param seconds  Duration of a full scale decay, from 1 to a sustain level of 0
+     * @param fsrecip  Reciprocal of sampling frequency (1/Fs)
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void setDecay(const float seconds, const float fsrecip) {
+      mDecayMult = multiplier(seconds, fsrecip, k_decay_undershoot);
+      refresh();
+    }
+
+    /**
+     * Set sustain level
+     *
+     * @param level  Sustain level in [0, 1]
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void setSustain(const float level) {
+      mSustain = clip01f(level);
+      refresh();
+    }
+
+    /**
+     * Set release time
+     *
+     * @param seconds  Duration of a full scale release, from 1 to 0
+     * @param fsrecip  Reciprocal of sampling frequency (1/Fs)
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void setRelease(const float seconds, const float fsrecip) {
+      mReleaseMult = multiplier(seconds, fsrecip, k_decay_undershoot);
+      refresh();
+    }
+
+    /**
+     * Start the attack stage from the current level
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void gateOn(void) {
+      enter(k_adsr_attack, level());
+    }
+
+    /**
+     * Start the release stage from the current level
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void gateOff(void) {
+      if (mStage != k_adsr_idle)
+        enter(k_adsr_release, level());
+    }
+
+    /**
+     * Current level
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    float level(void) const {
+      return mTarget + mDelta;
+    }
+
+    /**
+     * Render a block of envelope values
+     *
+     * @param out  Output buffer
+     * @param frames  Size of buffer
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void process(float * out, uint32_t frames) {
+      while (frames) {
+        const uint32_t n = (mRemaining < frames) ? mRemaining : frames;
+        const float target = mTarget;
+        const float mult = mMult;
+        float delta = mDelta;
+        for (uint32_t i = 0; i < n; ++i) {
+          delta *= mult;
+          out[i] = target + delta;
+        }
+        mDelta = delta;
+        out += n;
+        frames -= n;
+        if (mRemaining != k_adsr_hold && (mRemaining -= n) == 0) {
+          // Note: last sample of the stage lands exactly on the end level
+          const float end = endLevel(mStage);
+          out[-1] = end;
+          enter(next(mStage), end);
+        }
+      }
+    }
+
+    /**
+     * Render one envelope value, for per-sample code paths
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    float process(void) {
+      float y;
+      process(&y, 1);
+      return y;
+    }
+
+    /*=====================================================================*/
+    /* Constants.                                                          */
+    /*=====================================================================*/
+
+    /** Segment length of the unbounded sustain and idle stages */
+    static const uint32_t k_adsr_hold = 0xFFFFFFFFU;
+
+    static constexpr float k_attack_overshoot = 0.3f;
+    static constexpr float k_decay_undershoot = 1e-4f;
+
+    /*=====================================================================*/
+    /* Data Members.                                                       */
+    /*=====================================================================*/
+
+    float mAttackMult;
+    float mDecayMult;
+    float mReleaseMult;
+    float mSustain;
+
+    AdsrStage mStage;
+    uint32_t mRemaining;
+    float mTarget;
+    float mDelta;
+    float mMult;
+
+  private:
+
+    inline __attribute__((optimize("Ofast"),always_inline))
+    float multiplier(const float seconds, const float fsrecip, const float ratio) const {
+      float samples = seconds / fsrecip;
+      if (samples < 1.f)
+        samples = 1.f;
+      return expf(-logf((1.f + ratio) / ratio) / samples);
+    }
+
+    inline __attribute__((optimize("Ofast"),always_inline))
+    float endLevel(const AdsrStage stage) const {
+      return (stage == k_adsr_attack) ? 1.f : (stage == k_adsr_decay || stage == k_adsr_sustain) ? mSustain : 0.f;
+    }
+
+    static inline __attribute__((optimize("Ofast"),always_inline))
+    AdsrStage next(const AdsrStage stage) {
+      switch (stage) {
+      case k_adsr_attack:
+        return k_adsr_decay;
+      case k_adsr_decay:
+      case k_adsr_sustain:
+        return k_adsr_sustain;
+      default:
+        return k_adsr_idle;
+      }
+    }
+
+    static inline __attribute__((optimize("Ofast"),always_inline))
+    uint32_t length(const float from, const float to, const float target, const float mult) {
+      const float r = (to - target) / (from - target);
+      if (!(r > 0.f && r < 1.f) || !(mult < 1.f))
+        return 0;
+      const float n = ceilf(logf(r) / logf(mult));
+      return (n < 4294967040.f) ? (uint32_t)n : k_adsr_hold - 1;
+    }
+
+    /**
+     * Closed form of a stage started at a given level, zero length stages are skipped
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void enter(AdsrStage stage, float level) {
+      for (;;) {
+        mStage = stage;
+        switch (stage) {
+        case k_adsr_attack:
+          mTarget = 1.f + k_attack_overshoot;
+          mMult = mAttackMult;
+          mRemaining = length(level, 1.f, mTarget, mMult);
+          break;
+        case k_adsr_decay:
+          mTarget = mSustain - k_decay_undershoot;
+          mMult = mDecayMult;
+          mRemaining = length(level, mSustain, mTarget, mMult);
+          break;
+        case k_adsr_release:
+          mTarget = -k_decay_undershoot;
+          mMult = mReleaseMult;
+          mRemaining = length(level, 0.f, mTarget, mMult);
+          break;
+        case k_adsr_sustain:
+          // Note: after a sustain change, glide to the new level at the decay rate before holding
+          if (fabsf(level - mSustain) > k_decay_undershoot) {
+            mTarget = (level > mSustain) ? mSustain - k_decay_undershoot : mSustain + k_decay_undershoot;
+            mMult = mDecayMult;
+            mRemaining = length(level, mSustain, mTarget, mMult);
+          }
+          else {
+            mTarget = mSustain;
+            mMult = 1.f;
+            mRemaining = k_adsr_hold;
+          }
+          break;
+        default:
+          mTarget = 0.f;
+          mMult = 1.f;
+          mRemaining = k_adsr_hold;
+          break;
+        }
+        mDelta = level - mTarget;
+        if (mRemaining)
+          return;
+        level = endLevel(stage);
+        stage = next(stage);
+      }
+    }
+
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void refresh(void) {
+      enter(mStage, level());
+    }
+  };
+}
+
+/** @} */
@@ -0,0 +1,395 @@
+#pragma once
+/*
+    BSD 3-Clause License
+
+    Copyright (c) 2018, KORG INC.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this
+      list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//*/
+
+/**
+ * @file    wavetable.hpp
+ * @brief   Mip-mapped wavetable built from single-cycle waveforms.
+ *
+ * @addtogroup dsp DSP
+ * @{
+ *
+ */
+
+#include "float_math.h"
+
+/**
+ * Common DSP Utilities
+ */
+namespace dsp {
+
+  /**
+   * Band-limited wavetable with one level per octave, built from an arbitrary
+   * single-cycle waveform.
+   *
+   * Level l keeps the harmonics of the waveform below kSize >> (l + 1), so that
+   * it can be scanned without aliasing up to a frequency of 2^l / kSize cycles
+   * per sample. The levels are computed with FFTs, at once with build(), e.g.
+   * from OSC_INIT, or one level per call with startBuild() and buildNext() so
+   * that a rebuild can be spread over several render calls. Scanning then
+   * costs at most two interpolated lookups per sample regardless of pitch:
+   * setFrequency() picks the pair of adjacent levels for the current pitch
+   * and the crossfade between them, removing the top octave of harmonics
+   * over the last kFadeSemitones of each octave. Below that mMix is 0 and
+   * scanning only mLo is enough.
+   *
+   * With the default template parameters the levels have the size of the
+   * wave banks of osc_api.h and can also be scanned with osc_wave_scan_block(),
+   * e.g. a 2048 sample base with 10 levels is WaveTable<11, 10>. Memory is
+   * Levels * (2^SizeExp + 1) floats.
+   *
+   * @tparam SizeExp  Base 2 logarithm of the level size, at least 2
+   * @tparam Levels   Number of levels, at most SizeExp - 1 are useful, the
+   *                  last one holding only the fundamental
+   */
+  template <uint32_t SizeExp = 7, uint32_t Levels = SizeExp - 1>
+  struct WaveTable {
+
+    /*=====================================================================*/
+    /* Types and Data Structures.                                          */
+    /*=====================================================================*/
+
+    enum {
+      kSizeExp = SizeExp,
+      kSize = 1U << SizeExp,
+      kLutSize = kSize + 1,   // guard sample, copy of the first one
+      kLevels = Levels,
+      kU32Shift = 32 - SizeExp,
+      kFadeSemitones = 3
+    };
+
+    /*=====================================================================*/
+    /* Constructor / Destructor.                                           */
+    /*=====================================================================*/
+
+    WaveTable(void) :
+      mLo(mTable[0]),
+      mHi(mTable[0]),
+      mMix(0.f),
+      mSize(0),
+      mNext(Levels)
+    {
+      for (uint32_t l = 0; l < Levels; ++l)
+        for (uint32_t i = 0; i < kLutSize; ++i)
+          mTable[l][i] = 0.f;
+      initTwiddles();
+    }
+
+    /*=====================================================================*/
+    /* Public Methods.                                                     */
+    /*=====================================================================*/
+
+    /**
+     * Build all levels from a single-cycle waveform
+     *
+     * The waveform is resampled to the level size in the frequency domain, so
+     * shorter waveforms such as the 128 sample wave banks of osc_api.h
+     * can be used with larger tables. Runs one forward and Levels inverse FFTs
+     * of kSize points, use startBuild() and buildNext() from render callbacks.
+     *
+     * @param wave  Waveform samples, e.g. wavesA[0]
+     * @param size  Number of samples, a power of 2 in [4, kSize]
+     * @return False if size is not supported, levels are left untouched
+     */
+    bool build(const float * wave, const uint32_t size) {
+      if (!startBuild(wave, size))
+        return false;
+      while (!buildNext()) { }
+      return true;
+    }
+
+    /**
+     * Start building the levels from a single-cycle waveform, see build()
+     *
+     * Runs the forward FFT only. The levels must not be scanned until
+     * buildNext() returns true, e.g. build into a spare table and swap it in.
+     *
+     * @param wave  Waveform samples, read during this call only
+     * @param size  Number of samples, a power of 2 in [4, kSize]
+     * @return False if size is not supported, nothing is started
+     */
+    bool startBuild(const float * wave, const uint32_t size) {
+      if (size < 4 || size > kSize || (size & (size - 1)))
+        return false;
+
+      // Note: spectrum kept in the last level until that level is computed
+      float * spectrum = mTable[Levels - 1];
+      for (uint32_t i = 0; i < size; ++i)
+        spectrum[i] = wave[i];
+      realfft(spectrum, size, false);
+
+      mSize = size;
+      mNext = 0;
+      return true;
+    }
+
+    /**
+     * Build the next level, one inverse FFT of kSize points
+     *
+     * @return True once all levels are built, or if no build was started
+     */
+    bool buildNext(void) {
+      if (mNext >= Levels)
+        return true;
+
+      // Note: resampling to kSize and the inverse transform scaling
+      const float * spectrum = mTable[Levels - 1];
+      const float scale = 2.f / mSize;
+      const uint32_t l = mNext;
+      float * t = mTable[l];
+      uint32_t keep = kSize >> (l + 1);
+      if (keep > (mSize >> 1))
+        keep = mSize >> 1;
+
+      // Note: packed spectrum, t[0] DC and t[1] Nyquist, then pairs of real and imaginary parts
+      t[0] = scale * spectrum[0];
+      t[1] = 0.f;
+      for (uint32_t k = 1; k < keep; ++k) {
+        t[2*k] = scale * spectrum[2*k];
+        t[2*k+1] = scale * spectrum[2*k+1];
+      }
+      for (uint32_t i = 2 * keep; i < kSize; ++i)
+        t[i] = 0.f;
+
+      realfft(t, kSize, true);
+      t[kSize] = t[0];
+
+      if (++mNext < Levels)
+        return false;
+      mLo = mHi = mTable[0];
+      mMix = 0.f;
+      return true;
+    }
+
+    /**
+     * Select the levels for a frequency, typically once per render call
+     *
+     * @param w0  Frequency in cycles per sample, e.g. from osc_w0f_for_note()
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    void setFrequency(const float w0) {
+      // Note: level l is alias free below y = l + 1, crossfade from l to l + 1 just below that
+      const float y = clipminmaxf(0.f, (w0 > 0.f) ? fastlog2f(w0) + (SizeExp + 1) : 0.f, Levels - 1);
+      const uint32_t l = (uint32_t)y;
+      mLo = mTable[l];
+      mHi = mTable[(l + 1 < Levels) ? l + 1 : l];
+      mMix = clipminf(0.f, (y - l) * (12.f / kFadeSemitones) - (12.f / kFadeSemitones - 1.f));
+    }
+
+    /**
+     * Scan the selected levels at a phase
+     *
+     * @param x  Phase in [0, 1)
+     * @return   Interpolated sample
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    float scanf(const float x) const {
+      const float x0f = x * kSize;
+      const uint32_t x0 = ((uint32_t)x0f) & (kSize - 1);
+      return lookup(x0, x0f - (uint32_t)x0f);
+    }
+
+    /**
+     * Scan the selected levels at a 32-bit fixed point phase
+     *
+     * @param x  Phase, a full cycle over the 32-bit range
+     * @return   Interpolated sample
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    float scanuf(const uint32_t x) const {
+      const float fr = (1.f / (1U << kU32Shift)) * (float)(x & ((1U << kU32Shift) - 1));
+      return lookup(x >> kU32Shift, fr);
+    }
+
+    /**
+     * @param level  Level index in [0, Levels - 1]
+     * @return       Level samples, kLutSize including the guard sample
+     */
+    inline __attribute__((optimize("Ofast"),always_inline))
+    const float * level(const uint32_t level) const {
+      return mTable[level];
+    }
+
+    /*=====================================================================*/
+    /* Data Members.                                                       */
+    /*=====================================================================*/
+
+    float mTable[Levels][kLutSize];
+
+    const float * mLo;
+    const float * mHi;
+    float mMix;
+
+    // Note: source size and next level of a build in progress, Levels when idle
+    uint32_t mSize;
+    uint32_t mNext;
+
+  private:
+
+    // Note: cosine and sine pairs of 2 pi k / kSize for k < kSize / 2, shared by all tables of a size
+    static float sTwiddle[kSize];
+    static bool sTwiddleReady;
+
+    static void initTwiddles(void) {
+      if (sTwiddleReady)
+        return;
+      for (uint32_t k = 0; k < kSize / 2; ++k) {
+        const float a = M_TWOPI * k / kSize;
+        sTwiddle[2*k] = cosf(a);
+        sTwiddle[2*k+1] = sinf(a);
+      }
+      sTwiddleReady = true;
+    }
+
+    inline __attribute__((optimize("Ofast"),always_inline))
+    float lookup(const uint32_t x0, const float fr) const {
+      const float lo = linintf(fr, mLo[x0], mLo[x0+1]);
+      const float hi = linintf(fr, mHi[x0], mHi[x0+1]);
+      return linintf(mMix, lo, hi);
+    }
+
+    /**
+     * In place complex FFT, unnormalized
+     *
+     * @param z  n interleaved complex values
+     * @param n  Number of complex values, a power of 2
+     * @param inverse  Positive exponent if true
+     */
+    static void fft(float * z, const uint32_t n, const bool inverse) {
+      for (uint32_t i = 1, j = 0; i < n; ++i) {
+        uint32_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+          j ^= bit;
+        j ^= bit;
+        if (i < j) {
+          float t = z[2*i]; z[2*i] = z[2*j]; z[2*j] = t;
+          t = z[2*i+1]; z[2*i+1] = z[2*j+1]; z[2*j+1] = t;
+        }
+      }
+
+      for (uint32_t len = 2; len <= n; len <<= 1) {
+        // Note: twiddles of 2 pi j / len
+        const uint32_t step = 2 * (kSize / len);
+        const float sign = inverse ? 1.f : -1.f;
+        const uint32_t half = len >> 1;
+        for (uint32_t j = 0; j < half; ++j) {
+          const float wr = sTwiddle[j * step];
+          const float wi = sign * sTwiddle[j * step + 1];
+          for (uint32_t k = j; k < n; k += len) {
+            float * a = z + 2 * k;
+            float * b = a + 2 * half;
+            const float tr = wr * b[0] - wi * b[1];
+            const float ti = wr * b[1] + wi * b[0];
+            b[0] = a[0] - tr;
+            b[1] = a[1] - ti;
+            a[0] += tr;
+            a[1] += ti;
+          }
+        }
+      }
+    }
+
+    /**
+     * In place FFT of real data with a half size complex FFT
+     *
+     * Forward: x[0..n-1] becomes the packed spectrum, x[0] DC, x[1] Nyquist,
+     * then real and imaginary parts of bins 1 to n/2 - 1.
+     * Inverse: the packed spectrum becomes n/2 times the signal.
+     *
+     * @param x  n values
+     * @param n  Number of values, a power of 2, at least 4
+     * @param inverse  Spectrum to signal if true
+     */
+    static void realfft(float * x, const uint32_t n, const bool inverse) {
+      const uint32_t m = n >> 1;
+      if (!inverse)
+        fft(x, m, false);
+
+      // Note: X[k] = E[k] + W^k O[k], E and O the spectra of the even and odd samples, W = exp(-2 pi i / n)
+      const uint32_t step = 2 * (kSize / n);
+      for (uint32_t k = 1; k <= (m >> 1); ++k) {
+        const float wr = sTwiddle[k * step];
+        const float wi = -sTwiddle[k * step + 1];
+        float * a = x + 2 * k;
+        float * b = x + 2 * (m - k);
+        if (!inverse) {
+          // E = (Z[k] + conj(Z[m-k])) / 2, O = (Z[k] - conj(Z[m-k])) / 2i
+          const float er = 0.5f * (a[0] + b[0]);
+          const float ei = 0.5f * (a[1] - b[1]);
+          const float or_ = 0.5f * (a[1] + b[1]);
+          const float oi = -0.5f * (a[0] - b[0]);
+          const float tr = wr * or_ - wi * oi;
+          const float ti = wr * oi + wi * or_;
+          // X[k] = E + W^k O, X[m-k] = conj(E - W^k O)
+          a[0] = er + tr;
+          a[1] = ei + ti;
+          b[0] = er - tr;
+          b[1] = ti - ei;
+        }
+        else {
+          // E = (X[k] + conj(X[m-k])) / 2, O = (X[k] - conj(X[m-k])) / 2W^k
+          const float er = 0.5f * (a[0] + b[0]);
+          const float ei = 0.5f * (a[1] - b[1]);
+          const float dr = 0.5f * (a[0] - b[0]);
+          const float di = 0.5f * (a[1] + b[1]);
+          const float or_ = wr * dr + wi * di;
+          const float oi = wr * di - wi * dr;
+          // Z[k] = E + i O, Z[m-k] = conj(E) + i conj(O)
+          a[0] = er - oi;
+          a[1] = ei + or_;
+          b[0] = er + oi;
+          b[1] = or_ - ei;
+        }
+      }
+
+      const float x0 = x[0];
+      if (!inverse) {
+        x[0] = x0 + x[1];
+        x[1] = x0 - x[1];
+      }
+      else {
+        x[0] = 0.5f * (x0 + x[1]);
+        x[1] = 0.5f * (x0 - x[1]);
+        fft(x, m, true);
+      }
+    }
+  };
+
+  template <uint32_t SizeExp, uint32_t Levels>
+  float WaveTable<SizeExp, Levels>::sTwiddle[WaveTable<SizeExp, Levels>::kSize];
+
+  template <uint32_t SizeExp, uint32_t Levels>
+  bool WaveTable<SizeExp, Levels>::sTwiddleReady = false;
+}
+
+/** @} */
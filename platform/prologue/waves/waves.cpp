@@ -43,10 +43,30 @@
 
 static Waves s_waves;
 
+// Note: samples scanned ahead per wave, bounds the stack usage of OSC_CYCLE
+static const uint32_t k_scan_frames = 16;
+
+// Note: scans the selected levels of a table into out, only the lower one when the crossfade is off
+static inline __attribute__((optimize("Ofast"),always_inline))
+uint32_t scan_levels(const Waves::WaveTable &wt, uint32_t phi, const uint32_t dphi,
+                     float * __restrict out, float * __restrict hi, const uint32_t n)
+{
+  if (wt.mMix == 0.f)
+    return osc_wave_scan_block(wt.mLo, phi, dphi, out, n);
+
+  osc_wave_scan_block(wt.mLo, phi, dphi, out, n);
+  phi = osc_wave_scan_block(wt.mHi, phi, dphi, hi, n);
+  for (uint32_t i = 0; i < n; ++i)
+    out[i] = linintf(wt.mMix, out[i], hi[i]);
+  return phi;
+}
+
 void OSC_INIT(uint32_t platform, uint32_t api)
 {
   (void)platform;
   (void)api;
+  s_waves.updateWaves(Waves::k_flag_wave0 | Waves::k_flag_wave1 | Waves::k_flag_subwave);
+  while (s_waves.buildWaves()) { }
 }
 
 void OSC_CYCLE(const user_osc_param_t * const params,
@@ -62,9 +82,10 @@ void OSC_CYCLE(const user_osc_param_t * const params,
     const uint32_t flags = s.flags;
     s.flags = Waves::k_flags_none;
     
-    s_waves.updatePitch(osc_w0f_for_note((params->pitch)>>8, params->pitch & 0xFF));
-    
     s_waves.updateWaves(flags);
+    s_waves.buildWaves();
+    
+    s_waves.updatePitch(osc_w0f_for_note((params->pitch)>>8, params->pitch & 0xFF));
     
     if (flags & Waves::k_flag_reset)
       s.reset();
@@ -79,54 +100,63 @@ void OSC_CYCLE(const user_osc_param_t * const params,
   }
   
   // Temporaries.
-  float phi0 = s.phi0;
-  float phi1 = s.phi1;
-  float phisub = s.phisub;
+  uint32_t phi0 = s.phi0;
+  uint32_t phi1 = s.phi1;
+  uint32_t phisub = s.phisub;
+
+  // Note: 32-bit fixed point phase increments, the phases wrap around on overflow
+  const uint32_t dphi0 = (uint32_t)(s.w00 * 4294967296.f);
+  const uint32_t dphi1 = (uint32_t)(s.w01 * 4294967296.f);
+  const uint32_t dphisub = (uint32_t)(s.w0sub * 4294967296.f);
 
   float lfoz = s.lfoz;
   const float lfo_inc = (s.lfo - lfoz) / frames;
   
-  const float ditheramt = p.bitcrush * 2e-008f;
-  
-  const float bitres = osc_bitresf(p.bitcrush);
-  const float bitres_recip = 1.f / bitres;
-
   const float submix = p.submix;
   const float ringmix = p.ringmix;
   
+  const Waves::WaveTable &wt0 = *s_waves.wt0;
+  const Waves::WaveTable &wt1 = *s_waves.wt1;
+  const Waves::WaveTable &wtsub = *s_waves.wtsub;
+
   dsp::BiQuad &prelpf = s_waves.prelpf;
   dsp::BiQuad &postlpf = s_waves.postlpf;
   
   q31_t * __restrict y = (q31_t *)yn;
-  const q31_t * y_e = y + frames;
   
-  for (; y != y_e; ) {
-
-    const float wavemix = clipminmaxf(0.005f, p.shape+lfoz, 0.995f);
-    
-    float sig = (1.f - wavemix) * osc_wave_scanf(s.wave0, phi0);
-    sig += wavemix * osc_wave_scanf(s.wave1, phi1);
-    
-    const float subsig = osc_wave_scanf(s.subwave, phisub);
-    sig = (1.f - submix) * sig + submix * subsig;
-    sig = (1.f - ringmix) * sig + ringmix * (subsig * sig);
-    sig = clip1m1f(sig);
-    
-    sig = prelpf.process_fo(sig);
-    sig += s.dither * osc_white();
-    sig = si_roundf(sig * s.bitres) * s.bitresrcp;
-    sig = postlpf.process_fo(sig);
-    sig = osc_softclipf(0.125f, sig);
-    
-    *(y++) = f32_to_q31(sig);
-    
-    phi0 += s.w00;
-    phi0 -= (uint32_t)phi0;
-    phi1 += s.w01;
-    phi1 -= (uint32_t)phi1;
-    phisub += s.w0sub;
-    phisub -= (uint32_t)phisub;
-    lfoz += lfo_inc;
+  for (uint32_t remaining = frames; remaining != 0; ) {
+    const uint32_t n = (remaining < k_scan_frames) ? remaining : k_scan_frames;
+    remaining -= n;
+
+    // Scan each wave ahead of the per sample processing
+    float w0[k_scan_frames], w1[k_scan_frames], wsub[k_scan_frames], hi[k_scan_frames];
+    
+    phi0 = scan_levels(wt0, phi0, dphi0, w0, hi, n);
+    phi1 = scan_levels(wt1, phi1, dphi1, w1, hi, n);
+    phisub = scan_levels(wtsub, phisub, dphisub, wsub, hi, n);
+    
+    for (uint32_t i = 0; i < n; ++i) {
+
+      const float wavemix = clipminmaxf(0.005f, p.shape+lfoz, 0.995f);
+      
+      float sig = (1.f - wavemix) * w0[i];
+      sig += wavemix * w1[i];
+      
+      const float subsig = wsub[i];
+      sig = (1.f - submix) * sig + submix * subsig;
+      sig = (1.f - ringmix) * sig + ringmix * (subsig * sig);
+      sig = clip1m1f(sig);
+      
+      sig = prelpf.process_fo(sig);
+      sig += s.dither * osc_white();
+      sig = si_roundf(sig * s.bitres) * s.bitresrcp;
+      sig = postlpf.process_fo(sig);
+      sig = osc_softclipf(0.125f, sig);
+      
+      *(y++) = f32_to_q31(sig);
+      
+      lfoz += lfo_inc;
+    }
   }
   
   s.phi0 = phi0;
@@ -41,9 +41,12 @@
 
 #include "userosc.h"
 #include "biquad.hpp"
+#include "wavetable.hpp"
 
 struct Waves {
 
+  typedef dsp::WaveTable<k_waves_size_exp> WaveTable;
+
   enum {
     k_flags_none    = 0,
     k_flag_wave0    = 1<<1,
@@ -81,9 +84,9 @@ struct Waves {
     const float   *wave0;
     const float   *wave1;
     const float   *subwave;
-          float    phi0;
-          float    phi1;
-          float    phisub;
+          uint32_t phi0;
+          uint32_t phi1;
+          uint32_t phisub;
           float    w00;
           float    w01;
           float    w0sub;
@@ -122,13 +125,20 @@ struct Waves {
     }
   };
 
-  Waves(void) {
+  Waves(void) :
+    wt0(&tables[0]),
+    wt1(&tables[1]),
+    wtsub(&tables[2]),
+    spare(&tables[3])
+  {
     init();
   }
 
   void init(void) {
     state = State();
     params = Params();
+    pending = k_flags_none;
+    building = k_flags_none;
     prelpf.mCoeffs.setPoleLP(0.8f);
     postlpf.mCoeffs.setFOLP(osc_tanpif(0.45f));
   }
@@ -141,6 +151,9 @@ struct Waves {
     state.w01 = w0 + drift * 5.20833333333333e-006f;
     // Sub one octave and a phase drift (0.15Hz@48KHz)
     state.w0sub = 0.5f * w0 + drift * 3.125e-006f;
+    wt0->setFrequency(state.w00);
+    wt1->setFrequency(state.w01);
+    wtsub->setFrequency(state.w0sub);
   }
     
   inline void updateWaves(const uint16_t flags) {
@@ -191,9 +204,59 @@ struct Waves {
       const uint8_t idx = params.subwave;
       state.subwave = wavesA[params.subwave];
     }
+
+    // Note: tables are rebuilt by buildWaves(), a build of a wave selected again is restarted
+    const uint16_t waves = flags & (k_flag_wave0 | k_flag_wave1 | k_flag_subwave);
+    pending |= waves;
+    if (building & waves)
+      building = k_flags_none;
+  }
+
+  /**
+   * Advance the rebuild of the pending wave tables by one step
+   *
+   * Each step is at most one FFT of k_waves_size points. The wave being
+   * rebuilt keeps playing its previous table until the new one is complete,
+   * the tables are then swapped. Call before updatePitch() so that a swapped
+   * in table gets its levels selected.
+   *
+   * @return True while tables remain to be rebuilt
+   */
+  inline bool buildWaves(void) {
+    if (building == k_flags_none) {
+      if (pending == k_flags_none)
+        return false;
+      if (pending & k_flag_wave0)
+        building = k_flag_wave0;
+      else if (pending & k_flag_wave1)
+        building = k_flag_wave1;
+      else
+        building = k_flag_subwave;
+      pending &= ~building;
+      const float * const wave = (building == k_flag_wave0) ? state.wave0
+        : (building == k_flag_wave1) ? state.wave1 : state.subwave;
+      spare->startBuild(wave, k_waves_size);
+      return true;
+    }
+
+    if (!spare->buildNext())
+      return true;
+
+    WaveTable * &target = (building == k_flag_wave0) ? wt0
+      : (building == k_flag_wave1) ? wt1 : wtsub;
+    WaveTable * const t = target;
+    target = spare;
+    spare = t;
+    building = k_flags_none;
+    return pending != k_flags_none;
   }
 
   State       state;
   Params      params;
   dsp::BiQuad prelpf, postlpf;
+  // Band-limited copies of the selected waves, and a spare table to rebuild into
+  WaveTable   tables[4];
+  WaveTable  *wt0, *wt1, *wtsub, *spare;
+  uint16_t    pending;
+  uint16_t    building;
 };